@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bit7z/bit7zlibrary.hpp"
+#include "bit7z/bitarchivereader.hpp"
+
+#include <cxxopts.hpp>
+
+#include <je2be.hpp>
+
+#include <fmt/core.h>
+#include <fmt/xchar.h>
+
+#include "../src/discovery.h"
+#include "../src/format.h"
+#include "../src/hash.h"
+#include "../src/util.h"
+
+// Benchmarks X360MSE against a corpus generated by 'X360MSE-corpus'.
+//
+// Each stage is measured on its own, in process, so a regression can be
+// pinned to a stage: discovery, format detection, hashing, copying,
+// extraction from each archive, parsing '_MinecraftSaveInfo' files and
+// conversion. Conversion is only measured if the saves of the corpus can be
+// converted, i.e. it was generated from real saves with '--template'. If the
+// path to the X360MSE executable is given, it is also run end to end in
+// directory, archive and single-file mode; runs where it exits with an error,
+// as when synthetic saves fail to convert, are timed and counted rather than
+// ending the benchmark. Every benchmark runs several times, and the fastest,
+// median and slowest runs are reported, along with the throughput of the
+// median run.
+
+/**
+ * The measurements of a benchmark.
+ */
+struct BenchmarkResult {
+    std::string name;
+    std::vector<std::chrono::nanoseconds> durations;
+    uintmax_t bytes = 0;
+
+    /**
+     * The number of runs that failed, e.g. where X360MSE exited with an error.
+     */
+    unsigned int failed_runs = 0;
+};
+
+/**
+ * Runs a benchmark several times.
+ *
+ * @param name the name of the benchmark.
+ * @param iterations the number of times to run the benchmark.
+ * @param setup the function to run before each run, outside the measurement.
+ * @param function the function to measure; returns the number of bytes it processed.
+ * @return the measurements.
+ */
+BenchmarkResult run_benchmark(
+        const std::string& name,
+        unsigned int iterations,
+        const std::function<void()>& setup,
+        const std::function<uintmax_t()>& function
+        ) {
+    auto result = BenchmarkResult { name, {}, 0, 0 };
+
+    for (unsigned int iteration = 0; iteration < iterations; iteration += 1) {
+        setup();
+
+        auto [duration, bytes] = x360mse::util::run_measuring<uintmax_t>(function);
+
+        result.durations.push_back(duration);
+        result.bytes = bytes;
+    }
+
+    std::ranges::sort(result.durations);
+
+    return result;
+}
+
+double to_ms(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double to_mb_per_s(uintmax_t bytes, std::chrono::nanoseconds duration) {
+    const auto seconds = std::chrono::duration<double>(duration).count();
+
+    return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+/**
+ * Writes the results as JSON, to compare runs against each other.
+ *
+ * @param path the file to write the results to.
+ * @param results the results to write.
+ */
+void write_results(const std::filesystem::path& path, const std::vector<BenchmarkResult>& results) {
+    std::string json = "{\n  \"benchmarks\": [";
+
+    for (size_t index = 0; index < results.size(); index += 1) {
+        const auto& result = results[index];
+        const auto median = result.durations[result.durations.size() / 2];
+
+        json += index == 0 ? "\n" : ",\n";
+        json += fmt::format(
+                "    {{ \"name\": \"{}\", \"iterations\": {}, \"failed_runs\": {}, \"min_ms\": {:.3f}, \"median_ms\": {:.3f}, \"max_ms\": {:.3f}, \"bytes\": {}, \"throughput_mb_s\": {:.3f} }}",
+                result.name,
+                result.durations.size(),
+                result.failed_runs,
+                to_ms(result.durations.front()),
+                to_ms(median),
+                to_ms(result.durations.back()),
+                result.bytes,
+                to_mb_per_s(result.bytes, median)
+        );
+    }
+
+    json += results.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+    auto stream = std::ofstream { path, std::ios::binary };
+    stream.write(json.data(), static_cast<std::streamsize>(json.size()));
+}
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("X360MSE-bench", "Benchmark X360MSE against a corpus generated by X360MSE-corpus");
+
+    options.add_options()
+            ("c,corpus", "Corpus folder, as generated by X360MSE-corpus", cxxopts::value<std::string>())
+            ("exe", "Path to the X360MSE executable, to also benchmark it end to end", cxxopts::value<std::string>())
+            ("n,iterations", "Number of runs of each benchmark", cxxopts::value<unsigned int>()->default_value("5"))
+            ("t,threads", "Number of threads to discover saves with (0 = all cores)", cxxopts::value<unsigned int>()->default_value("0"))
+            ("filter", "Only run the benchmarks whose name matches this pattern", cxxopts::value<std::string>()->default_value(".*"))
+            ("out", "File to write the results to as JSON", cxxopts::value<std::string>())
+            ("h,help", "Print usage");
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("corpus")) {
+        fmt::println("{}", options.help());
+
+        return EXIT_SUCCESS;
+    }
+
+    try {
+        const auto corpus_directory = std::filesystem::path(result["corpus"].as<std::string>());
+        const auto directory_root = corpus_directory / "directory";
+        const auto iterations = std::max(1u, result["iterations"].as<unsigned int>());
+        const auto filter = std::regex { result["filter"].as<std::string>() };
+
+        auto thread_total = result["threads"].as<unsigned int>();
+
+        if (thread_total == 0) {
+            thread_total = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        const auto minecraft_save_info_pattern = std::wregex { LR"(_MinecraftSaveInfo)" };
+        const auto save_file_pattern = std::wregex { LR"(Save(.+)\.bin)" };
+
+        // Index the corpus once; every stage below works from this list.
+        std::vector<std::filesystem::path> save_files;
+        std::vector<std::filesystem::path> save_info_files;
+        uintmax_t corpus_size = 0;
+        uintmax_t save_info_size = 0;
+
+        for (const auto& save_directory : x360mse::discovery::discover(directory_root, minecraft_save_info_pattern, save_file_pattern, thread_total).directories) {
+            for (const auto& path : save_directory.save_files) {
+                save_files.push_back(path);
+                corpus_size += std::filesystem::file_size(path);
+            }
+
+            if (save_directory.save_info_file) {
+                save_info_files.push_back(*save_directory.save_info_file);
+                save_info_size += std::filesystem::file_size(*save_directory.save_info_file);
+            }
+        }
+
+        if (save_files.empty()) {
+            fmt::println(stderr, "[Error] No save files found in {}; generate a corpus with X360MSE-corpus first.", directory_root.string());
+
+            return EXIT_FAILURE;
+        }
+
+        fmt::println("Benchmarking against {} save file(s), {} bytes in total, {} run(s) each.", save_files.size(), corpus_size, iterations);
+        fmt::println("");
+
+        const auto scratch_directory = std::filesystem::temp_directory_path() / "x360mse-bench";
+
+        auto clear_scratch = [&]() {
+            std::filesystem::remove_all(scratch_directory);
+            std::filesystem::create_directories(scratch_directory);
+        };
+
+        std::vector<BenchmarkResult> results;
+
+        // Counts the runs of the current benchmark that failed.
+        unsigned int failed_runs = 0;
+
+        auto bench = [&](const std::string& name, const std::function<void()>& setup, const std::function<uintmax_t()>& function) {
+            if (!std::regex_search(name, filter)) {
+                return;
+            }
+
+            failed_runs = 0;
+
+            auto& benchmark = results.emplace_back(run_benchmark(name, iterations, setup, function));
+            const auto median = benchmark.durations[benchmark.durations.size() / 2];
+
+            benchmark.failed_runs = failed_runs;
+
+            fmt::println(
+                    "{:<24} min {:>10.3f}ms  median {:>10.3f}ms  max {:>10.3f}ms  {:>10.3f}MB/s",
+                    benchmark.name,
+                    to_ms(benchmark.durations.front()),
+                    to_ms(median),
+                    to_ms(benchmark.durations.back()),
+                    to_mb_per_s(benchmark.bytes, median)
+            );
+
+            if (benchmark.failed_runs > 0) {
+                fmt::println("{:<24} {} of {} run(s) failed", "", benchmark.failed_runs, benchmark.durations.size());
+            }
+        };
+
+        const auto no_setup = []() {};
+
+        // Stages, measured in process.
+        bench("stage.discovery", no_setup, [&]() -> uintmax_t {
+            const auto discovery = x360mse::discovery::discover(directory_root, minecraft_save_info_pattern, save_file_pattern, thread_total);
+
+            return discovery.directories.empty() ? 0 : corpus_size;
+        });
+
+        bench("stage.detection", no_setup, [&]() -> uintmax_t {
+            for (const auto& path : save_files) {
+                if (x360mse::format::detect(path) != x360mse::format::InputFormat::SAVE_BIN) {
+                    throw std::runtime_error("Save file not detected as such: " + path.string());
+                }
+            }
+
+            return save_files.size() * x360mse::format::HEADER_SIZE;
+        });
+
+        bench("stage.hashing", no_setup, [&]() -> uintmax_t {
+            for (const auto& path : save_files) {
+                x360mse::hash::xxh64_file(path);
+            }
+
+            return corpus_size;
+        });
+
+        bench("stage.copy", clear_scratch, [&]() -> uintmax_t {
+            size_t index = 0;
+
+            for (const auto& path : save_files) {
+                std::filesystem::copy_file(path, scratch_directory / fmt::format("{}-{}", index++, path.filename().string()));
+            }
+
+            return corpus_size;
+        });
+
+        bit7z::Bit7zLibrary lib7z { L"7z.dll" };
+
+        for (const auto& extension : { "7z", "zip" }) {
+            const auto archive_path = corpus_directory / fmt::format("corpus.{}", extension);
+
+            if (!std::filesystem::exists(archive_path)) {
+                continue;
+            }
+
+            const auto& archive_format = x360mse::format::to_bit7z(x360mse::format::detect(archive_path));
+
+            bench(fmt::format("stage.extraction.{}", extension), no_setup, [&]() -> uintmax_t {
+                auto reader = bit7z::BitArchiveReader { lib7z, archive_path.native(), archive_format };
+
+                uintmax_t extracted = 0;
+
+                for (const auto& info : reader.items()) {
+                    if (info.isDir() || !std::regex_match(info.name(), save_file_pattern)) {
+                        continue;
+                    }
+
+                    std::vector<bit7z::byte_t> buffer;
+                    reader.extractTo(buffer, info.index());
+
+                    extracted += buffer.size();
+                }
+
+                return extracted;
+            });
+        }
+
+        // Every save must be paired with a save bin to be converted, so check
+        // the '_MinecraftSaveInfo' files of the corpus parse before timing them.
+        for (const auto& path : save_info_files) {
+            std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+            je2be::xbox360::MinecraftSaveInfo::Parse(path, bins);
+
+            if (bins.empty()) {
+                fmt::println(stderr, "[Warning] No save bin could be parsed from {}; X360MSE will not find save bins for its saves.", path.string());
+            }
+        }
+
+        bench("stage.parse_save_info", no_setup, [&]() -> uintmax_t {
+            for (const auto& path : save_info_files) {
+                std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+                je2be::xbox360::MinecraftSaveInfo::Parse(path, bins);
+            }
+
+            return save_info_size;
+        });
+
+        // Convert a save to a Java Edition world in the scratch folder, as X360MSE does with a single job.
+        auto convert = [&](const std::filesystem::path& path, size_t index) {
+            je2be::lce::Options convert_options;
+            convert_options.fTempDirectory = scratch_directory / fmt::format("temp-{}", index);
+
+            const auto world_path = scratch_directory / fmt::format("world-{}", index);
+
+            std::filesystem::create_directories(*convert_options.fTempDirectory);
+            std::filesystem::create_directories(world_path);
+
+            return je2be::xbox360::Converter::Run(path, world_path, thread_total, convert_options, nullptr);
+        };
+
+        // Synthetic saves cannot be converted, so only measure conversion if a save of the corpus converts.
+        if (std::regex_search("stage.conversion", filter)) {
+            clear_scratch();
+
+            if (convert(save_files.front(), 0).error()) {
+                fmt::println("{:<24} skipped, as the saves of the corpus cannot be converted; generate it with --template", "stage.conversion");
+            } else {
+                bench("stage.conversion", clear_scratch, [&]() -> uintmax_t {
+                    size_t index = 0;
+
+                    for (const auto& path : save_files) {
+                        if (convert(path, index++).error()) {
+                            failed_runs += 1;
+                        }
+                    }
+
+                    return corpus_size;
+                });
+            }
+        }
+
+        // The whole program, in each of its modes.
+        if (result.count("exe")) {
+            const auto executable = std::filesystem::path(result["exe"].as<std::string>());
+
+            auto run_program = [&](const std::filesystem::path& input, uintmax_t bytes) -> uintmax_t {
+                const auto command = fmt::format("\"{}\" -q -i \"{}\" -o \"{}\"", executable.string(), input.string(), (scratch_directory / "output").string());
+
+                // Saves failing to convert make X360MSE exit with an error; the run is still timed.
+                if (std::system(command.c_str()) != 0) {
+                    failed_runs += 1;
+                }
+
+                return bytes;
+            };
+
+            bench("e2e.directory", clear_scratch, [&]() {
+                return run_program(directory_root, corpus_size);
+            });
+
+            for (const auto& extension : { "7z", "zip" }) {
+                const auto archive_path = corpus_directory / fmt::format("corpus.{}", extension);
+
+                if (std::filesystem::exists(archive_path)) {
+                    bench(fmt::format("e2e.archive.{}", extension), clear_scratch, [&]() {
+                        return run_program(archive_path, corpus_size);
+                    });
+                }
+            }
+
+            const auto largest_save = *std::ranges::max_element(save_files, {}, [](const auto& path) {
+                return std::filesystem::file_size(path);
+            });
+
+            bench("e2e.single", clear_scratch, [&]() {
+                return run_program(largest_save, std::filesystem::file_size(largest_save));
+            });
+        }
+
+        std::filesystem::remove_all(scratch_directory);
+
+        if (result.count("out")) {
+            write_results(result["out"].as<std::string>(), results);
+        }
+    } catch (const std::exception& ex) {
+        fmt::println(stderr, "[Error] {}", ex.what());
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
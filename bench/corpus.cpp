@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bit7z/bit7zlibrary.hpp"
+#include "bit7z/bitfilecompressor.hpp"
+
+#include <cxxopts.hpp>
+
+#include <fmt/core.h>
+#include <fmt/xchar.h>
+
+// Generates a reproducible corpus of Xbox 360 saves to benchmark X360MSE against.
+//
+// The corpus is laid out like a mounted Xbox 360 hard drive, with one folder
+// per profile, and is also packed into 7z and zip archives:
+//
+//   <output>/directory/Content/<profile>/584111F7/00000001/Save*.bin
+//   <output>/corpus.7z
+//   <output>/corpus.zip
+//
+// Synthetic saves carry the signature of a console-signed package and a
+// payload of the requested compressibility, which is enough to exercise
+// discovery, detection, hashing, copying and extraction. Each profile also
+// gets a '_MinecraftSaveInfo' file naming its saves, so they are paired with
+// a save bin like real ones. They cannot be converted; to benchmark
+// conversion, pass a folder holding real saves and their '_MinecraftSaveInfo'
+// file with '--template', and it is replicated into every profile instead.
+
+// The title identifier of Minecraft: Xbox 360 Edition.
+constexpr auto MINECRAFT_TITLE_ID = "584111F7";
+
+/**
+ * Writes a synthetic save file.
+ *
+ * @param path the file to write.
+ * @param size the size of the file in bytes.
+ * @param compressibility the fraction of the payload made of repeated bytes, between 0 and 1.
+ * @param random the random generator to draw the payload from.
+ */
+void write_synthetic_save(const std::filesystem::path& path, uintmax_t size, double compressibility, std::mt19937_64& random) {
+    constexpr size_t BLOCK_SIZE = 4096;
+
+    auto stream = std::ofstream { path, std::ios::binary };
+
+    std::vector<uint8_t> block(BLOCK_SIZE);
+    std::bernoulli_distribution repeated_block { compressibility };
+
+    uintmax_t written = 0;
+
+    while (written < size) {
+        if (repeated_block(random)) {
+            std::ranges::fill(block, static_cast<uint8_t>(random()));
+        } else {
+            for (auto& byte : block) {
+                byte = static_cast<uint8_t>(random());
+            }
+        }
+
+        // Every save starts with the signature of a console-signed package.
+        if (written == 0) {
+            std::ranges::copy(std::string_view { "CON " }, block.begin());
+        }
+
+        const auto count = static_cast<size_t>(std::min<uintmax_t>(BLOCK_SIZE, size - written));
+
+        stream.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(count));
+        written += count;
+    }
+
+    if (!stream) {
+        throw std::runtime_error("Failed to write " + path.string());
+    }
+}
+
+/**
+ * A save listed in a '_MinecraftSaveInfo' file.
+ */
+struct SaveInfoEntry {
+    std::u16string title;
+    std::string file_name;
+};
+
+/**
+ * Writes a '_MinecraftSaveInfo' file listing the saves of a profile.
+ *
+ * All integers are big-endian. The file starts with a version (1) and the
+ * number of saves; each save follows as its title, length-prefixed in UTF-16
+ * code units, its file name, length-prefixed in bytes, and its thumbnail,
+ * size-prefixed and left empty here.
+ *
+ * @param path the file to write.
+ * @param entries the saves to list.
+ */
+void write_save_info(const std::filesystem::path& path, const std::vector<SaveInfoEntry>& entries) {
+    std::string data;
+
+    auto write_u32 = [&](uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            data.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    };
+
+    write_u32(1);
+    write_u32(static_cast<uint32_t>(entries.size()));
+
+    for (const auto& entry : entries) {
+        write_u32(static_cast<uint32_t>(entry.title.size()));
+
+        for (const auto unit : entry.title) {
+            data.push_back(static_cast<char>(unit >> 8));
+            data.push_back(static_cast<char>(unit & 0xFF));
+        }
+
+        write_u32(static_cast<uint32_t>(entry.file_name.size()));
+        data += entry.file_name;
+
+        // No thumbnail.
+        write_u32(0);
+    }
+
+    auto stream = std::ofstream { path, std::ios::binary };
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+    if (!stream) {
+        throw std::runtime_error("Failed to write " + path.string());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("X360MSE-corpus", "Generate a reproducible corpus of Xbox 360 saves to benchmark X360MSE against");
+
+    options.add_options()
+            ("o,output", "Output folder", cxxopts::value<std::string>())
+            ("seed", "Seed of the random generator; the same seed always generates the same corpus", cxxopts::value<uint64_t>()->default_value("360"))
+            ("profiles", "Number of profiles", cxxopts::value<unsigned int>()->default_value("4"))
+            ("saves", "Number of synthetic saves per profile", cxxopts::value<unsigned int>()->default_value("8"))
+            ("min-size", "Minimum size of a synthetic save in bytes", cxxopts::value<uintmax_t>()->default_value("262144"))
+            ("max-size", "Maximum size of a synthetic save in bytes", cxxopts::value<uintmax_t>()->default_value("67108864"))
+            ("compressibility", "Fraction of the payload of synthetic saves made of repeated bytes", cxxopts::value<double>()->default_value("0.5"))
+            ("template", "Folder holding real saves and their '_MinecraftSaveInfo' file, replicated into every profile instead of synthetic saves", cxxopts::value<std::string>())
+            ("no-archives", "Do not pack the corpus into archives")
+            ("h,help", "Print usage");
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("output")) {
+        fmt::println("{}", options.help());
+
+        return EXIT_SUCCESS;
+    }
+
+    try {
+        const auto output_directory = std::filesystem::path(result["output"].as<std::string>());
+        const auto directory_root = output_directory / "directory";
+
+        const auto profile_total = result["profiles"].as<unsigned int>();
+        const auto save_total = result["saves"].as<unsigned int>();
+        const auto min_size = result["min-size"].as<uintmax_t>();
+        const auto max_size = std::max(min_size, result["max-size"].as<uintmax_t>());
+        const auto compressibility = std::clamp(result["compressibility"].as<double>(), 0.0, 1.0);
+
+        const auto template_directory = result.count("template") ?
+                std::make_optional<std::filesystem::path>(result["template"].as<std::string>()) :
+                std::nullopt;
+
+        // Start from an empty corpus, so the same seed always produces the same files.
+        std::filesystem::remove_all(directory_root);
+
+        auto random = std::mt19937_64 { result["seed"].as<uint64_t>() };
+
+        // Draw sizes log-uniformly, as real saves range from fresh worlds to years of play.
+        std::uniform_real_distribution<double> log_size { std::log(static_cast<double>(min_size)), std::log(static_cast<double>(max_size)) };
+
+        uintmax_t corpus_size = 0;
+        size_t corpus_total = 0;
+
+        for (unsigned int profile_index = 0; profile_index < profile_total; profile_index += 1) {
+            const auto profile_directory = directory_root / "Content" / fmt::format("E0000{:011X}", random() & 0xFFFFFFFFFFFull) / MINECRAFT_TITLE_ID / "00000001";
+
+            std::filesystem::create_directories(profile_directory);
+
+            if (template_directory) {
+                for (const auto& entry : std::filesystem::directory_iterator(*template_directory)) {
+                    if (!entry.is_regular_file()) {
+                        continue;
+                    }
+
+                    std::filesystem::copy_file(entry.path(), profile_directory / entry.path().filename());
+
+                    corpus_size += entry.file_size();
+                    corpus_total += 1;
+                }
+
+                continue;
+            }
+
+            std::vector<SaveInfoEntry> save_info_entries;
+
+            for (unsigned int save_index = 0; save_index < save_total; save_index += 1) {
+                const auto size = static_cast<uintmax_t>(std::exp(log_size(random)));
+                const auto file_name = fmt::format("Save{:04}{:02}{:02}{:02}{:02}{:02}.bin", 2012 + save_index % 10, 1 + save_index % 12, 1 + profile_index % 28, save_index % 24, profile_index % 60, save_index % 60);
+
+                write_synthetic_save(profile_directory / file_name, size, compressibility, random);
+
+                const auto title = fmt::format("Corpus World {}-{}", profile_index + 1, save_index + 1);
+
+                save_info_entries.push_back({ std::u16string(title.begin(), title.end()), file_name });
+
+                corpus_size += size;
+                corpus_total += 1;
+            }
+
+            write_save_info(profile_directory / "_MinecraftSaveInfo", save_info_entries);
+        }
+
+        fmt::println("Generated {} file(s), {} bytes in total, in {}", corpus_total, corpus_size, directory_root.string());
+
+        if (result.count("no-archives")) {
+            return EXIT_SUCCESS;
+        }
+
+        bit7z::Bit7zLibrary lib7z { L"7z.dll" };
+
+        for (const auto& [format, extension] : { std::pair { &bit7z::BitFormat::SevenZip, "7z" }, std::pair { &bit7z::BitFormat::Zip, "zip" } }) {
+            const auto archive_path = output_directory / fmt::format("corpus.{}", extension);
+
+            std::filesystem::remove(archive_path);
+
+            bit7z::BitFileCompressor compressor { lib7z, *format };
+            compressor.compressDirectory(directory_root.native(), archive_path.native());
+
+            fmt::println("Packed the corpus into {} ({} bytes)", archive_path.string(), std::filesystem::file_size(archive_path));
+        }
+    } catch (const std::exception& ex) {
+        fmt::println(stderr, "[Error] {}", ex.what());
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
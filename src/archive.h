@@ -0,0 +1,133 @@
+#ifndef X360MSE_ARCHIVE_H
+#define X360MSE_ARCHIVE_H
+
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "bit7z/bit7zlibrary.hpp"
+#include "bit7z/bitfilecompressor.hpp"
+#include "bit7z/bitformat.hpp"
+
+namespace x360mse::archive {
+    /**
+     * The format of the archives converted worlds are written to.
+     */
+    enum class OutputFormat {
+        ZIP,
+        SEVEN_ZIP,
+        TAR,
+    };
+
+    /**
+     * Parses the name of an output format.
+     *
+     * @param name the name of the format: 'folder', 'zip', '7z' or 'tar'.
+     * @return the format, or nothing if worlds are written as folders.
+     * @throws std::invalid_argument if the name is not a supported format.
+     */
+    inline std::optional<OutputFormat> parse_output_format(const std::string& name) {
+        if (name == "folder") {
+            return std::nullopt;
+        }
+
+        if (name == "zip") {
+            return OutputFormat::ZIP;
+        }
+
+        if (name == "7z") {
+            return OutputFormat::SEVEN_ZIP;
+        }
+
+        if (name == "tar") {
+            return OutputFormat::TAR;
+        }
+
+        if (name == "tar.zst") {
+            throw std::invalid_argument("Zstandard is not supported by 7z.dll; use 'tar', 'zip' or '7z' instead");
+        }
+
+        throw std::invalid_argument("Unknown output format: " + name);
+    }
+
+    /**
+     * @param format the output format.
+     * @return the extension of archives of the format, including the leading dot.
+     */
+    inline std::wstring extension(OutputFormat format) {
+        switch (format) {
+            case OutputFormat::ZIP: return L".zip";
+            case OutputFormat::SEVEN_ZIP: return L".7z";
+            case OutputFormat::TAR: return L".tar";
+            default: return {};
+        }
+    }
+
+    /**
+     * @param format the output format.
+     * @return the bit7z format.
+     */
+    inline const bit7z::BitInOutFormat& to_bit7z(OutputFormat format) {
+        switch (format) {
+            case OutputFormat::SEVEN_ZIP: return bit7z::BitFormat::SevenZip;
+            case OutputFormat::TAR: return bit7z::BitFormat::Tar;
+            default: return bit7z::BitFormat::Zip;
+        }
+    }
+
+    /**
+     * Packs converted worlds into archives.
+     *
+     * Worlds are converted into the scratch space, which lives in memory when
+     * they fit, and packed from there, so their loose files never reach the
+     * output folder. Files are compressed on several threads at once.
+     */
+    class WorldArchiver {
+    public:
+        /**
+         * @param lib7z the bit7z instance.
+         * @param format the format of the archives.
+         */
+        WorldArchiver(const bit7z::Bit7zLibrary& lib7z, OutputFormat format)
+                : lib7z_(lib7z), format_(format) {
+        }
+
+        /**
+         * @return the format of the archives.
+         */
+        [[nodiscard]] OutputFormat format() const {
+            return format_;
+        }
+
+        /**
+         * Packs a converted world into an archive.
+         *
+         * The archive is written next to its final path first, then moved into
+         * place, so an interrupted run never leaves a truncated archive behind.
+         *
+         * @param world_directory the folder of the world; becomes the root folder of the archive.
+         * @param archive_path the path of the archive; replaced if it exists.
+         * @param thread_count the number of threads to compress with.
+         */
+        void write(const std::filesystem::path& world_directory, const std::filesystem::path& archive_path, unsigned int thread_count) const {
+            auto partial_path = archive_path;
+            partial_path += ".partial";
+
+            std::error_code error;
+            std::filesystem::remove(partial_path, error);
+
+            bit7z::BitFileCompressor compressor { lib7z_, to_bit7z(format_) };
+            compressor.setThreadsCount(thread_count);
+            compressor.compressDirectory(world_directory.wstring(), partial_path.wstring());
+
+            std::filesystem::rename(partial_path, archive_path);
+        }
+
+    private:
+        const bit7z::Bit7zLibrary& lib7z_;
+        OutputFormat format_;
+    };
+}
+
+#endif
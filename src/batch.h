@@ -0,0 +1,178 @@
+#ifndef X360MSE_BATCH_H
+#define X360MSE_BATCH_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util.h"
+
+namespace x360mse::batch {
+    /**
+     * An input of a run, and the folder its saves are converted into.
+     */
+    struct Input {
+        std::filesystem::path path;
+        std::filesystem::path output_directory;
+    };
+
+    /**
+     * Reads the inputs listed in a manifest file.
+     *
+     * Each line names an input, optionally followed by a tab and the folder
+     * to convert its saves into. Relative paths are resolved against the
+     * folder of the manifest. Empty lines and lines starting with '#' are
+     * skipped.
+     *
+     * @param manifest_path the manifest file.
+     * @param default_output_directory the folder to convert saves into when a line names none.
+     * @return the inputs, in the order they are listed.
+     * @throws std::invalid_argument if the manifest cannot be read, or a line names no output folder and there is no default.
+     */
+    inline std::vector<Input> parse_manifest(
+            const std::filesystem::path& manifest_path,
+            const std::optional<std::filesystem::path>& default_output_directory
+            ) {
+        auto stream = std::ifstream { manifest_path, std::ios::binary };
+
+        if (!stream) {
+            throw std::invalid_argument("Cannot read manifest " + x360mse::util::to_utf8(manifest_path.wstring()));
+        }
+
+        const auto base_directory = manifest_path.parent_path();
+
+        auto resolve = [&](const std::string& text) {
+            return base_directory / std::filesystem::path(x360mse::util::to_wstring(text));
+        };
+
+        std::vector<Input> inputs;
+        std::string line;
+        size_t line_number = 0;
+
+        while (std::getline(stream, line)) {
+            line_number += 1;
+
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+
+            if (line.empty() || line.front() == '#') {
+                continue;
+            }
+
+            const auto separator = line.find('\t');
+
+            if (separator == std::string::npos) {
+                if (!default_output_directory) {
+                    throw std::invalid_argument("No output folder for line " + std::to_string(line_number) + " of the manifest, and no default given with --output");
+                }
+
+                inputs.push_back({ resolve(line), *default_output_directory });
+            } else {
+                inputs.push_back({ resolve(line.substr(0, separator)), resolve(line.substr(separator + 1)) });
+            }
+        }
+
+        return inputs;
+    }
+
+    /**
+     * Hands the inputs of a run to the threads reading them, as they arrive.
+     *
+     * Inputs may keep arriving while earlier ones are read, e.g. when a drop
+     * folder is watched; readers wait for the next one until the queue is
+     * closed. Thread-safe.
+     */
+    class InputQueue {
+    public:
+        /**
+         * An input taken from the queue, and its index in the order inputs were added.
+         */
+        struct Taken {
+            size_t index;
+            Input input;
+        };
+
+        /**
+         * Adds an input to read.
+         *
+         * @param input the input.
+         */
+        void push(Input input) {
+            {
+                std::lock_guard lock(mutex_);
+                inputs_.push_back(std::move(input));
+                pushed_count_ += 1;
+            }
+
+            condition_.notify_one();
+        }
+
+        /**
+         * Waits for the next input to read.
+         *
+         * @return the input, or nothing once the queue was closed and every input was taken.
+         */
+        std::optional<Taken> pop() {
+            std::unique_lock lock(mutex_);
+
+            condition_.wait(lock, [&]() { return closed_ || !inputs_.empty(); });
+
+            if (inputs_.empty()) {
+                return std::nullopt;
+            }
+
+            auto taken = Taken { taken_count_++, std::move(inputs_.front()) };
+            inputs_.pop_front();
+
+            return taken;
+        }
+
+        /**
+         * @return the number of inputs added so far.
+         */
+        [[nodiscard]] size_t pushed_count() const {
+            std::lock_guard lock(mutex_);
+
+            return pushed_count_;
+        }
+
+        /**
+         * @return the number of inputs added in total, once the queue was closed.
+         */
+        [[nodiscard]] std::optional<size_t> total() const {
+            std::lock_guard lock(mutex_);
+
+            return closed_ ? std::make_optional(pushed_count_) : std::nullopt;
+        }
+
+        /**
+         * Lets the readers finish once every input was taken.
+         */
+        void close() {
+            {
+                std::lock_guard lock(mutex_);
+                closed_ = true;
+            }
+
+            condition_.notify_all();
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::condition_variable condition_;
+        std::deque<Input> inputs_;
+        size_t pushed_count_ = 0;
+        size_t taken_count_ = 0;
+        bool closed_ = false;
+    };
+}
+
+#endif
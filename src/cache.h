@@ -0,0 +1,272 @@
+#ifndef X360MSE_CACHE_H
+#define X360MSE_CACHE_H
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+
+#include "copy.h"
+#include "hash.h"
+#include "save_source.h"
+
+namespace x360mse::cache {
+    /**
+     * Mirrors a file, cloning it where the file system supports it and
+     * copying it otherwise.
+     *
+     * Files are never hard linked, as Minecraft rewrites region files in
+     * place: playing a world restored by hard links would change the cached
+     * world, and every other world restored from it.
+     *
+     * @param from the file to mirror.
+     * @param to the path to mirror it to; replaced if it exists.
+     */
+    inline void mirror_file(const std::filesystem::path& from, const std::filesystem::path& to) {
+        std::error_code error;
+        std::filesystem::remove(to, error);
+
+        x360mse::copy::copy_file(from, to, false);
+    }
+
+    /**
+     * Mirrors a folder tree, cloning files where the file system supports
+     * it and copying them otherwise.
+     *
+     * @param from the folder to mirror.
+     * @param to the folder to mirror into; created if it does not exist.
+     */
+    inline void mirror_tree(const std::filesystem::path& from, const std::filesystem::path& to) {
+        std::filesystem::create_directories(to);
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(from)) {
+            const auto target = to / std::filesystem::relative(entry.path(), from);
+
+            if (entry.is_directory()) {
+                std::filesystem::create_directories(target);
+            } else if (entry.is_regular_file()) {
+                mirror_file(entry.path(), target);
+            }
+        }
+    }
+
+    /**
+     * Caches converted worlds by the contents of their save file.
+     *
+     * Keys combine a hash of the save file, the title of the save, the settings
+     * changing the output and the version of the converter, so a world is only
+     * reused if converting again would produce the same output. Identical saves
+     * found during the same run are converted once; the others wait for that
+     * conversion and reuse it.
+     *
+     * If a directory is given, converted worlds are also kept there across runs.
+     * Worlds are restored by cloning their files where the file system supports
+     * it (Btrfs, XFS, APFS), so the cache is best kept on the same volume as the
+     * output, and by copying them otherwise. Worlds written as a single archive
+     * are cached as that archive.
+     */
+    class ConversionCache {
+    public:
+        /**
+         * @param directory the directory to keep converted worlds in across runs, if any.
+         * @param converter_version the version of the converter producing the worlds.
+         */
+        ConversionCache(std::optional<std::filesystem::path> directory, std::string converter_version)
+                : directory_(std::move(directory)), converter_version_(std::move(converter_version)) {
+            if (directory_) {
+                std::filesystem::create_directories(*directory_);
+            }
+        }
+
+        /**
+         * Computes the cache key of a save.
+         *
+         * @param source the save to compute the key of.
+         * @param title the title of the save, as UTF-8.
+         * @param settings any other setting changing the converted world, e.g. level overrides.
+         * @return the cache key.
+         */
+        [[nodiscard]] std::string key(const x360mse::source::SaveSource& source, const std::string& title, const std::string& settings = {}) const {
+            const auto content_hash = source.in_memory() ?
+                    x360mse::hash::xxh64(source.data().data(), source.data().size()) :
+                    x360mse::hash::xxh64_file(*source.path());
+
+            x360mse::hash::Xxh64 context_hasher;
+            context_hasher.update(title.data(), title.size());
+            context_hasher.update("\0", 1);
+            context_hasher.update(converter_version_.data(), converter_version_.size());
+            context_hasher.update("\0", 1);
+            context_hasher.update(settings.data(), settings.size());
+
+            return x360mse::hash::to_hex(content_hash) + "-" + x360mse::hash::to_hex(context_hasher.digest());
+        }
+
+        /**
+         * Restores the converted world of a save into the output path, if it is known.
+         *
+         * If the same save is being converted by another thread, waits for that
+         * conversion to complete. If this returns false, the caller becomes
+         * responsible for converting the save and must call {#store} afterward,
+         * even if the conversion failed.
+         *
+         * @param key the cache key of the save.
+         * @param output_path the directory, or the archive, to restore the world into.
+         * @return whether the world was restored.
+         */
+        bool restore(const std::string& key, const std::filesystem::path& output_path) {
+            std::unique_lock lock(mutex_);
+
+            while (true) {
+                const auto entry = entries_.find(key);
+
+                if (entry == entries_.end()) {
+                    break;
+                }
+
+                if (entry->second.pending) {
+                    condition_.wait(lock);
+                    continue;
+                }
+
+                if (!entry->second.world_path) {
+                    // The previous conversion failed; take over and try again.
+                    entry->second.pending = true;
+                    return false;
+                }
+
+                const auto world_path = *entry->second.world_path;
+
+                lock.unlock();
+                restore_from(world_path, output_path);
+
+                return true;
+            }
+
+            if (directory_) {
+                const auto world_path = *directory_ / key;
+
+                if (std::filesystem::exists(world_path / COMPLETE_MARKER)) {
+                    entries_[key] = Entry { false, world_path };
+
+                    lock.unlock();
+                    restore_from(world_path, output_path);
+
+                    return true;
+                }
+            }
+
+            entries_[key] = Entry { true, std::nullopt };
+
+            return false;
+        }
+
+        /**
+         * Records the outcome of converting a save, after {#restore} returned false.
+         *
+         * @param key the cache key of the save.
+         * @param output_path the directory, or the archive, the world was converted into.
+         * @param converted whether the conversion succeeded.
+         */
+        void store(const std::string& key, const std::filesystem::path& output_path, bool converted) {
+            std::optional<std::filesystem::path> world_path;
+
+            if (converted) {
+                world_path = output_path;
+
+                if (directory_) {
+                    try {
+                        world_path = persist(key, output_path);
+                    } catch (const std::exception&) {
+                        // Failing to persist only costs a conversion in a later run.
+                    }
+                }
+            }
+
+            {
+                std::lock_guard lock(mutex_);
+                entries_[key] = Entry { false, world_path };
+            }
+
+            condition_.notify_all();
+        }
+
+    private:
+        static constexpr auto COMPLETE_MARKER = ".x360mse-complete";
+
+        // The name of the archive inside a cached folder, for worlds written as a single archive.
+        static constexpr auto ARCHIVE_FILE = "world-archive";
+
+        struct Entry {
+            bool pending;
+            std::optional<std::filesystem::path> world_path;
+        };
+
+        static void restore_from(const std::filesystem::path& world_path, const std::filesystem::path& output_path) {
+            if (std::filesystem::is_regular_file(world_path)) {
+                mirror_file(world_path, output_path);
+                return;
+            }
+
+            if (std::filesystem::is_regular_file(world_path / ARCHIVE_FILE)) {
+                mirror_file(world_path / ARCHIVE_FILE, output_path);
+                return;
+            }
+
+            mirror_tree(world_path, output_path);
+
+            std::error_code error;
+            std::filesystem::remove(output_path / COMPLETE_MARKER, error);
+        }
+
+        std::filesystem::path persist(const std::string& key, const std::filesystem::path& output_path) {
+            const auto world_path = *directory_ / key;
+
+            if (std::filesystem::exists(world_path / COMPLETE_MARKER)) {
+                return world_path;
+            }
+
+            // Populate a uniquely named folder first, then move it into place,
+            // so concurrent runs sharing the cache never see a partial world.
+            auto random = std::mt19937_64 { std::random_device {}() };
+            const auto staging_path = *directory_ / (key + ".tmp-" + x360mse::hash::to_hex(random()));
+
+            if (std::filesystem::is_regular_file(output_path)) {
+                std::filesystem::create_directories(staging_path);
+                mirror_file(output_path, staging_path / ARCHIVE_FILE);
+            } else {
+                mirror_tree(output_path, staging_path);
+            }
+
+            std::ofstream { staging_path / COMPLETE_MARKER };
+
+            std::error_code error;
+
+            // Remove a partial world left behind by an interrupted run.
+            if (std::filesystem::exists(world_path)) {
+                std::filesystem::remove_all(world_path, error);
+            }
+
+            std::filesystem::rename(staging_path, world_path, error);
+
+            if (error) {
+                // Another run stored the same world first.
+                std::filesystem::remove_all(staging_path, error);
+            }
+
+            return world_path;
+        }
+
+        std::optional<std::filesystem::path> directory_;
+        std::string converter_version_;
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::map<std::string, Entry> entries_;
+    };
+}
+
+#endif
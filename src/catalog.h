@@ -0,0 +1,143 @@
+#ifndef X360MSE_CATALOG_H
+#define X360MSE_CATALOG_H
+
+#include <algorithm>
+#include <cwctype>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <je2be.hpp>
+
+#include "save_source.h"
+#include "util.h"
+
+namespace x360mse::catalog {
+    using SaveBin = je2be::xbox360::MinecraftSaveInfo::SaveBin;
+
+    /**
+     * Indexes the save bins listed by '_MinecraftSaveInfo' files, and
+     * records which save bin each extracted or copied save belongs to.
+     *
+     * File names of save bins are normalized once when they are added, so
+     * that resolving a save file to its bin is a single exact lookup.
+     * Save bins are scoped to the folder of the '_MinecraftSaveInfo' file
+     * listing them, as different profiles may use the same file names.
+     */
+    class SaveCatalog {
+    public:
+        /**
+         * Normalizes a save file name for lookups.
+         *
+         * Surrounding spaces are removed and ASCII letters are lowercased,
+         * as Xbox 360 file names are case-insensitive.
+         *
+         * @param file_name the file name to normalize.
+         * @return the normalized file name.
+         */
+        static std::wstring normalize(const std::wstring& file_name) {
+            const auto first = file_name.find_first_not_of(L' ');
+
+            if (first == std::wstring::npos) {
+                return {};
+            }
+
+            const auto last = file_name.find_last_not_of(L' ');
+
+            auto normalized = file_name.substr(first, last - first + 1);
+
+            std::ranges::transform(normalized, normalized.begin(), [](wchar_t character) {
+                return character < 0x80 ? static_cast<wchar_t>(std::towlower(character)) : character;
+            });
+
+            return normalized;
+        }
+
+        /**
+         * Adds the save bins listed by a '_MinecraftSaveInfo' file.
+         *
+         * @param scope the folder holding the '_MinecraftSaveInfo' file.
+         * @param bins the save bins listed by the file.
+         */
+        void add_save_info(const std::filesystem::path& scope, const std::vector<SaveBin>& bins) {
+            std::lock_guard lock(mutex_);
+
+            for (const auto& bin : bins) {
+                const auto file_name = normalize(x360mse::util::to_wstring(bin.fFileName));
+
+                scoped_bins_[scoped_key(scope, file_name)] = bin;
+                bins_by_file_name_[file_name].push_back(bin);
+            }
+        }
+
+        /**
+         * Finds the save bin of a save file.
+         *
+         * Save bins listed in the same folder as the save file are preferred.
+         * Otherwise, a save bin from any folder is used, as long as it is the
+         * only one with that file name.
+         *
+         * @param scope the folder holding the save file.
+         * @param file_name the name of the save file.
+         * @return the save bin, if found.
+         */
+        [[nodiscard]] std::optional<SaveBin> find_bin(const std::filesystem::path& scope, const std::wstring& file_name) const {
+            std::lock_guard lock(mutex_);
+
+            const auto normalized = normalize(file_name);
+
+            if (const auto bin = scoped_bins_.find(scoped_key(scope, normalized)); bin != scoped_bins_.end()) {
+                return bin->second;
+            }
+
+            if (const auto bins = bins_by_file_name_.find(normalized); bins != bins_by_file_name_.end() && bins->second.size() == 1) {
+                return bins->second.front();
+            }
+
+            return std::nullopt;
+        }
+
+        /**
+         * Records the save bin a save belongs to.
+         *
+         * @param source the save.
+         * @param bin the save bin describing it.
+         */
+        void assign(const x360mse::source::SaveSource& source, const SaveBin& bin) {
+            std::lock_guard lock(mutex_);
+
+            assigned_bins_[source.id()] = bin;
+        }
+
+        /**
+         * Resolves the save bin recorded for a save.
+         *
+         * @param source the save.
+         * @return the save bin, if one was recorded.
+         */
+        [[nodiscard]] std::optional<SaveBin> resolve(const x360mse::source::SaveSource& source) const {
+            std::lock_guard lock(mutex_);
+
+            if (const auto bin = assigned_bins_.find(source.id()); bin != assigned_bins_.end()) {
+                return bin->second;
+            }
+
+            return std::nullopt;
+        }
+
+    private:
+        static std::wstring scoped_key(const std::filesystem::path& scope, const std::wstring& file_name) {
+            return scope.lexically_normal().generic_wstring() + L'\0' + file_name;
+        }
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::wstring, SaveBin> scoped_bins_;
+        std::unordered_map<std::wstring, std::vector<SaveBin>> bins_by_file_name_;
+        std::unordered_map<uint64_t, SaveBin> assigned_bins_;
+    };
+}
+
+#endif
@@ -0,0 +1,2316 @@
+#include "converter.h"
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+#include "bit7z/bit7zlibrary.hpp"
+#include "bit7z/bitarchivereader.hpp"
+
+#include <defer.hpp>
+
+#include <fmt/core.h>
+#include <fmt/xchar.h>
+
+#include <je2be.hpp>
+
+#include <minecraft-file.hpp>
+
+#include "cache.h"
+#include "catalog.h"
+#include "copy.h"
+#include "discovery.h"
+#include "fatx.h"
+#include "format.h"
+#include "governor.h"
+#include "journal.h"
+#include "save_source.h"
+#include "scratch.h"
+#include "scheduler.h"
+#include "util.h"
+#include "unicode.hpp"
+
+
+// Shorten the namespaces for ease of use.
+namespace uc = unicode;
+
+namespace x360mse::converter {
+    namespace {
+        using x360mse::events::Event;
+        using x360mse::events::EventType;
+
+        /**
+         * The state of an input, shared by the thread reading it and the tasks converting its saves.
+         */
+        struct InputContext {
+            x360mse::batch::Input input;
+            size_t index = 0;
+
+            x360mse::events::Reporter reporter;
+            ResultHandler on_result;
+            std::promise<InputResult> promise;
+            std::stop_token stop;
+
+            x360mse::journal::Journal* journal = nullptr;
+
+            // Save bins are only looked up within the input listing them.
+            x360mse::catalog::SaveCatalog catalog;
+
+            std::atomic<bool> read = false;
+
+            // The reading of the input, and the conversions of its saves, still running.
+            std::atomic<size_t> outstanding = 1;
+
+            /**
+             * @return whether the input was cancelled.
+             */
+            [[nodiscard]] bool cancelled() const {
+                return stop.stop_requested();
+            }
+
+            /**
+             * Records and reports an error of the input.
+             *
+             * @param message what went wrong.
+             */
+            void error(std::wstring message) {
+                {
+                    std::lock_guard lock(mutex);
+                    errors.push_back(message);
+                }
+
+                reporter.error(std::move(message));
+            }
+
+            /**
+             * Records what became of a save of the input.
+             *
+             * @param save the outcome of the save.
+             */
+            void add_save(SaveResult save) {
+                std::lock_guard lock(mutex);
+                saves.push_back(std::move(save));
+            }
+
+            /**
+             * @return the result of the input, once nothing of it is running anymore.
+             */
+            InputResult result() {
+                std::lock_guard lock(mutex);
+
+                return { input, index, read, cancelled(), std::move(saves), std::move(errors) };
+            }
+
+        private:
+            std::mutex mutex;
+            std::vector<SaveResult> saves;
+            std::vector<std::wstring> errors;
+        };
+
+        /**
+         * @param ex the exception.
+         * @return the message reporting the exception.
+         */
+        std::wstring exception_message(const std::exception& ex) {
+            return fmt::format(L"An exception has occurred!\n{}", x360mse::util::to_wstring(std::string(ex.what())));
+        }
+
+        /**
+         * @param title the title of a save bin.
+         * @return the title, as UTF-8.
+         */
+        std::string title_of(const std::u16string& title) {
+            return x360mse::util::to_utf8(x360mse::util::to_wstring(title));
+        }
+
+        /**
+         * Applies hooks to the 'level.dat' of a converted world.
+         *
+         * Every hook is applied in a single pass, so the file is only decompressed,
+         * parsed and compressed again once. The edited file replaces the original
+         * through a rename, so a world restored from the cache by a clone is
+         * never edited in place.
+         *
+         * @param level_dat_path the path of the 'level.dat' file.
+         * @param hooks the hooks to apply to its 'Data' tag.
+         * @param report_error the function to report what went wrong to.
+         * @return whether the hooks were applied.
+         */
+        bool apply_level_hooks(
+                const std::filesystem::path& level_dat_path,
+                const std::vector<x360mse::level::LevelHook>& hooks,
+                const std::function<void(std::wstring)>& report_error
+                ) {
+            // Check if the level.dat file exists.
+            if (!std::filesystem::exists(level_dat_path)) {
+                report_error(fmt::format(L"File does not exist: {}", level_dat_path.wstring()));
+
+                return false;
+            }
+
+            if (hooks.empty()) {
+                return true;
+            }
+
+            // Read the level.dat file.
+            auto in_stream = std::make_shared<mcfile::stream::GzFileInputStream>(level_dat_path);
+            auto in_root = mcfile::nbt::CompoundTag::Read(in_stream, mcfile::Endian::Big);
+
+            in_stream.reset();
+
+            if (!in_root) {
+                report_error(fmt::format(L"Failed to read file: {}", level_dat_path.wstring()));
+
+                return false;
+            }
+
+            // Access the "Data" compound tag.
+            auto data_tag = in_root->compoundTag(u8"Data");
+            if (!data_tag) {
+                report_error(fmt::format(L"File does not contain 'Data' tag: {}", level_dat_path.wstring()));
+
+                return false;
+            }
+
+            for (const auto& hook : hooks) {
+                hook(*data_tag);
+            }
+
+            // Write the modified data next to the file, then move it into place.
+            auto edited_path = level_dat_path;
+            edited_path += ".x360mse";
+
+            {
+                auto out_stream = std::make_shared<mcfile::stream::GzFileOutputStream>(edited_path);
+
+                if (!mcfile::nbt::CompoundTag::Write(*in_root, out_stream, mcfile::Endian::Big)) {
+                    report_error(fmt::format(L"Failed to write updated file: {}", level_dat_path.wstring()));
+
+                    return false;
+                }
+            }
+
+            std::filesystem::rename(edited_path, level_dat_path);
+
+            return true;
+        }
+
+        /**
+         * Generates a unique path in the specified directory with the specified name.
+         *
+         * If a file already exists with the same name, it will append a number to the name.
+         * Otherwise, it will return the path as is.
+         *
+         * @param directory the directory to generate the unique path in.
+         * @param name the name of the file.
+         * @return the unique path.
+         */
+        std::wstring unique_path(const std::filesystem::path& directory, const std::filesystem::path& name) {
+            auto path = directory / name;
+
+            if (!std::filesystem::exists(path)) {
+                return path.wstring();
+            }
+
+            int counter = 1;
+
+            auto stem = path.stem().string();
+            auto extension = path.extension().string();
+
+            while (std::filesystem::exists(path)) {
+                counter += 1;
+
+                // Append the counter to the stem of the path.
+                // Ex.: "file (1).bin", "file (2).bin", etc.
+                path = directory / std::filesystem::path(stem + " (" + std::to_string(counter) + ")" + extension);
+            }
+
+            return path.wstring();
+        }
+
+        /**
+         * Creates a folder under a unique name in the specified directory.
+         *
+         * Unlike {#unique_path}, the name is taken by creating the folder,
+         * so readers running at once never end up sharing a folder.
+         *
+         * @param directory the directory to create the folder in.
+         * @param name the name of the folder; a number is appended if it is taken.
+         * @return the folder created.
+         * @throws std::filesystem::filesystem_error if the folder could not be created.
+         */
+        std::filesystem::path create_unique_directory(const std::filesystem::path& directory, const std::filesystem::path& name) {
+            for (int counter = 1; ; counter += 1) {
+                const auto path = counter == 1 ?
+                        directory / name :
+                        directory / std::filesystem::path(name.wstring() + L" (" + std::to_wstring(counter) + L")");
+
+                std::error_code error;
+
+                if (std::filesystem::create_directory(path, error)) {
+                    return path;
+                }
+
+                // Anything else than a taken name is a real failure.
+                if (!std::filesystem::exists(path)) {
+                    throw std::filesystem::filesystem_error("Failed to create directory", path, error);
+                }
+            }
+        }
+
+        /**
+         * @return the lock held while output names are picked and taken, as every input read at once may write to the same output directory.
+         */
+        std::mutex& reservation_mutex() {
+            static std::mutex mutex;
+
+            return mutex;
+        }
+
+        /**
+         * Reserves a unique file name in the specified directory by creating an empty file under it.
+         *
+         * @param directory the directory to reserve the name in.
+         * @param name the name of the file; a number is appended if it is taken.
+         * @return the path of the empty file.
+         */
+        std::filesystem::path reserve_file(const std::filesystem::path& directory, const std::filesystem::path& name) {
+            std::lock_guard lock(reservation_mutex());
+
+            const auto path = std::filesystem::path(unique_path(directory, name));
+
+            // Create the file before releasing the lock, so no other input picks the same name.
+            auto stream = std::ofstream { path, std::ios::binary };
+
+            if (!stream) {
+                throw std::runtime_error("Failed to create " + path.string());
+            }
+
+            return path;
+        }
+
+        /**
+         * Copies a file into the specified directory under a unique name.
+         *
+         * The name is reserved first; the file is copied next to it, as
+         * {@code copy::copy_file} never overwrites, and moved over it once complete.
+         *
+         * @param from the file to copy.
+         * @param directory the directory to copy the file to.
+         * @param name the name of the copy; a number is appended if it is taken.
+         * @return the path of the copy, and how it was made.
+         */
+        std::pair<std::filesystem::path, x360mse::copy::CopyMethod> copy_to_unique_path(
+                const std::filesystem::path& from,
+                const std::filesystem::path& directory,
+                const std::filesystem::path& name
+                ) {
+            const auto output_path = reserve_file(directory, name);
+
+            auto partial_path = output_path;
+            partial_path += ".x360mse-partial";
+
+            try {
+                // Left behind if an earlier run was interrupted while copying.
+                std::filesystem::remove(partial_path);
+
+                const auto copy_method = x360mse::copy::copy_file(from, partial_path);
+                std::filesystem::rename(partial_path, output_path);
+
+                return { output_path, copy_method };
+            } catch (...) {
+                std::error_code error;
+                std::filesystem::remove(partial_path, error);
+                std::filesystem::remove(output_path, error);
+
+                throw;
+            }
+        }
+
+        /**
+         * Removes an output reserved for a world that was not written, so an
+         * empty archive or folder is not mistaken for a converted world.
+         *
+         * Archives are removed even if partly written; folders only if empty.
+         *
+         * @param path the output to remove.
+         */
+        void discard_output(const std::filesystem::path& path) {
+            std::error_code error;
+
+            if (!std::filesystem::is_directory(path, error) || std::filesystem::is_empty(path, error)) {
+                std::filesystem::remove(path, error);
+            }
+        }
+
+        /**
+         * Converts the specified file from a Minecraft Xbox 360 Edition
+         * to a Minecraft Java Edition save file, and to a Minecraft Bedrock
+         * Edition world if requested.
+         *
+         * The save is decoded once, into a Java Edition world; Bedrock Edition
+         * worlds are converted from that world, while the Java Edition world is
+         * packed. Each world is output as an uncompressed folder, or as an archive
+         * if an archiver is given. Worlds packed into archives, and Java Edition
+         * worlds only needed to produce other editions, are converted into the
+         * scratch space, so their loose files never reach the output folder.
+         *
+         * If an identical save was already converted, in this run or in a run
+         * sharing the same cache directory, its worlds are reused instead. If an
+         * interrupted run already converted the save into the output folder,
+         * only its 'level.dat' is updated.
+         *
+         * @param source the save to convert.
+         * @param outputs the worlds to write, by edition.
+         * @param file_index the index of the file in the total.
+         * @param file_total the total number of files to convert.
+         * @param bin the save bin describing the file.
+         * @param thread_count the number of threads the converter may use.
+         * @param cache the cache of converted worlds.
+         * @param metrics the report to record the time taken by each stage in.
+         * @param scratch the scratch space to write the intermediate files of the conversion to.
+         * @param overrides the overrides to apply to the 'level.dat' of the world.
+         * @param selection the dimensions and chunks of the save to convert.
+         * @param archiver the archiver to pack the worlds with, if they are written as archives.
+         * @param context the input of the save, with the journal to record its progress in.
+         * @param governor the governor to report the memory taken by the conversion to.
+         * @return what became of the save.
+         */
+        SaveResult convert_file(
+                const x360mse::source::SaveSource& source,
+                const std::vector<x360mse::edition::Output>& outputs,
+                const size_t file_index,
+                const size_t file_total,
+                const je2be::xbox360::MinecraftSaveInfo::SaveBin& bin,
+                const unsigned int thread_count,
+                x360mse::cache::ConversionCache& cache,
+                x360mse::metrics::MetricsReport& metrics,
+                x360mse::scratch::ScratchSpace& scratch,
+                const x360mse::level::LevelOverrides& overrides,
+                const x360mse::selection::Selection& selection,
+                const std::optional<x360mse::archive::WorldArchiver>& archiver,
+                InputContext& context,
+                x360mse::governor::MemoryGovernor& governor
+                ) {
+            const auto& reporter = context.reporter;
+            auto& journal = *context.journal;
+
+            const auto position = x360mse::events::Position { file_index, file_total };
+
+            SaveResult result { source.name(), title_of(bin.fTitle), SaveOutcome::FAILED, outputs };
+
+            // Errors of the save are reported as they happen, and kept in its result.
+            std::mutex error_mutex;
+
+            const auto fail = [&](std::wstring message) {
+                {
+                    std::lock_guard lock(error_mutex);
+                    result.errors.push_back(message);
+                }
+
+                reporter.error(std::move(message));
+            };
+
+            // Measure the memory taken by the conversion, to admit the next ones accordingly.
+            auto memory_watch = governor.watch(source.size());
+
+            try {
+                // Modify 'level.dat' of the converted world to match the bin data's level name,
+                // along with any overrides, in a single pass.
+                auto level_hooks = overrides.hooks();
+                level_hooks.push_back(x360mse::level::set_level_name(x360mse::util::to_string(bin.fTitle)));
+
+                const auto java_only = outputs.size() == 1 && outputs.front().edition == x360mse::edition::Edition::JAVA;
+
+                // Finish a world converted into the output folder by an interrupted run.
+                if (const auto entry = journal.find(source.origin()); java_only && !archiver && entry && entry->state == x360mse::journal::State::CONVERTED) {
+                    const auto level_dat_path = outputs.front().path / "level.dat";
+
+                    if (std::filesystem::exists(level_dat_path) && apply_level_hooks(level_dat_path, level_hooks, fail)) {
+                        journal.record(source.origin(), x360mse::journal::State::FINALIZED);
+
+                        reporter.emit({
+                                .type = EventType::SAVE_CONVERTED,
+                                .position = position,
+                                .message = fmt::format(L"Finished the conversion of {} from an earlier run!", source.name()),
+                        });
+
+                        result.outcome = SaveOutcome::RESUMED;
+
+                        return result;
+                    }
+                }
+
+                // A world still to convert, and whether it was.
+                struct PendingOutput {
+                    x360mse::edition::Output output;
+                    std::string cache_key;
+                    bool converted = false;
+                };
+
+                std::vector<PendingOutput> pending_outputs;
+
+                // Record the outcome of each conversion, so identical saves waiting on it can proceed,
+                // and drop the outputs reserved for worlds that were not written.
+                defer {
+                    for (const auto& pending : pending_outputs) {
+                        cache.store(pending.cache_key, pending.output.path, pending.converted);
+
+                        if (!pending.converted) {
+                            discard_output(pending.output.path);
+                        }
+                    }
+                };
+
+                // Reuse the worlds converted from an identical save, if any; each edition is cached on its own.
+                const auto settings = overrides.fingerprint() + selection.fingerprint() + (archiver ? x360mse::util::to_utf8(x360mse::archive::extension(archiver->format())) : "");
+
+                for (const auto& output : outputs) {
+                    const auto cache_key = cache.key(
+                            source,
+                            x360mse::util::to_string(bin.fTitle),
+                            output.edition == x360mse::edition::Edition::JAVA ? settings : settings + "|" + x360mse::edition::to_string(output.edition)
+                    );
+
+                    if (!cache.restore(cache_key, output.path)) {
+                        pending_outputs.push_back({ output, cache_key });
+                    }
+                }
+
+                if (pending_outputs.empty()) {
+                    journal.record(source.origin(), x360mse::journal::State::FINALIZED);
+
+                    reporter.emit({
+                            .type = EventType::SAVE_CONVERTED,
+                            .position = position,
+                            .message = fmt::format(L"Reused the conversion of an identical save for {}!", source.name()),
+                    });
+
+                    result.outcome = SaveOutcome::REUSED;
+
+                    return result;
+                }
+
+                auto pending_of = [&](x360mse::edition::Edition edition) -> PendingOutput* {
+                    const auto pending = std::ranges::find_if(pending_outputs, [&](const PendingOutput& candidate) {
+                        return candidate.output.edition == edition;
+                    });
+
+                    return pending == pending_outputs.end() ? nullptr : &*pending;
+                };
+
+                auto* const java_output = pending_of(x360mse::edition::Edition::JAVA);
+                auto* const bedrock_output = pending_of(x360mse::edition::Edition::BEDROCK);
+
+                // Lease an empty scratch folder for the intermediate files, in memory if
+                // they fit; it is cleaned and handed back when the function exits.
+                // Worlds packed into archives, or only converted from, are converted there too.
+                const auto java_in_scratch = archiver || !java_output;
+                const auto world_total = (java_in_scratch ? 1 : 0) + (archiver && bedrock_output ? 1 : 0);
+
+                auto scratch_area = std::make_optional(scratch.acquire(source.size() * (
+                        x360mse::scratch::ScratchSpace::INTERMEDIATE_FACTOR +
+                        x360mse::scratch::ScratchSpace::WORLD_FACTOR * world_total)));
+
+                const auto world_name = outputs.front().path.stem();
+
+                std::filesystem::path world_path;
+
+                // Convert the save into the scratch folder currently leased.
+                auto convert = [&]() {
+                    je2be::lce::Options convert_options;
+                    convert_options.fTempDirectory = scratch_area->path() / "temp";
+
+                    std::filesystem::create_directories(*convert_options.fTempDirectory);
+
+                    // Skip the dimensions and chunks outside the selection before they are decompressed.
+                    // Other editions are converted from the Java Edition world, so they only hold the selection too.
+                    selection.apply(convert_options);
+
+                    world_path = java_in_scratch ? scratch_area->path() / "world" / world_name : java_output->output.path;
+
+                    std::filesystem::create_directories(world_path);
+
+                    // Make the save readable by the converter, even if it is held in memory.
+                    const auto materialized_save = source.materialize(scratch_area->path());
+
+                    // A memory file holds a copy of the save the resident size does not show.
+                    const auto materialized_size = materialized_save.in_memory() ? source.size() : 0;
+
+                    governor.hold(materialized_size);
+
+                    defer {
+                        governor.drop(materialized_size);
+                    };
+
+                    return je2be::xbox360::Converter::Run(materialized_save.path(), world_path, thread_count, convert_options, nullptr);
+                };
+
+                reporter.emit({
+                        .type = EventType::CONVERSION_STARTED,
+                        .position = position,
+                        .message = fmt::format(L"Converting {} with {} thread(s)...", source.name(), thread_count),
+                });
+
+                // Run the conversion and measure the time it takes.
+                auto conversion_job = reporter.begin_job(fmt::format(L"Converting {}...", source.name()));
+
+                auto [duration_ms, status] = x360mse::util::run_measuring_ms<je2be::Status>([&]() {
+                    std::optional<je2be::Status> conversion_status;
+
+                    try {
+                        conversion_status = convert();
+                    } catch (const std::filesystem::filesystem_error&) {
+                        if (!scratch_area->exhausted()) {
+                            throw;
+                        }
+                    }
+
+                    // The intermediate files outgrew the memory-backed scratch folder;
+                    // spill them to disk and convert again, once.
+                    if ((!conversion_status || conversion_status->error()) && scratch_area->exhausted()) {
+                        scratch_area.reset();
+                        scratch_area.emplace(scratch.acquire_on_disk());
+
+                        if (!java_in_scratch) {
+                            std::filesystem::remove_all(world_path);
+                        }
+
+                        conversion_status = convert();
+                    }
+
+                    return *conversion_status;
+                }, [&](std::chrono::nanoseconds duration) {
+                    metrics.record(source.id(), x360mse::metrics::Stage::CONVERSION, duration, source.size());
+                });
+
+                conversion_job.end();
+
+                result.duration = std::chrono::milliseconds(duration_ms);
+
+                if (!status.error()) {
+                    journal.record(source.origin(), x360mse::journal::State::CONVERTED);
+                }
+
+                const auto level_dat_path = world_path / "level.dat";
+
+                bool level_name_set = false;
+
+                const auto level_name_duration = x360mse::util::run_measuring([&]() {
+                    level_name_set = apply_level_hooks(level_dat_path, level_hooks, fail);
+                });
+
+                std::error_code level_dat_error;
+                const auto level_dat_size = std::filesystem::file_size(level_dat_path, level_dat_error);
+
+                metrics.record(source.id(), x360mse::metrics::Stage::SET_LEVEL_NAME, level_name_duration, level_dat_error ? 0 : level_dat_size);
+
+                if (!level_name_set) {
+                    fail(fmt::format(L"Failed to set level name in file: {}", level_dat_path.wstring()));
+                }
+
+                if (auto err = status.error(); err) {
+                    result.errors.push_back(fmt::format(L"Failed to convert {}!", source.name()));
+
+                    reporter.emit({
+                            .type = EventType::SAVE_FAILED,
+                            .position = position,
+                            .message = fmt::format(L"Failed to convert {}!", source.name()),
+                            .duration = result.duration,
+                    });
+                } else {
+                    // Pack a world into its archive, on as many threads as the conversion had.
+                    auto pack = [&](const std::filesystem::path& world, const std::filesystem::path& archive_path) {
+                        auto packing_job = reporter.begin_job(fmt::format(L"Packing {}...", archive_path.filename().wstring()));
+
+                        const auto packing_duration = x360mse::util::run_measuring([&]() {
+                            archiver->write(world, archive_path, thread_count);
+                        });
+
+                        metrics.record(source.id(), x360mse::metrics::Stage::ARCHIVE, packing_duration, std::filesystem::file_size(archive_path));
+                    };
+
+                    if (level_name_set) {
+                        // Convert the Java Edition world to Bedrock Edition, including its
+                        // new level name, while the Java Edition world is packed.
+                        std::future<bool> bedrock_conversion;
+
+                        if (bedrock_output) {
+                            bedrock_conversion = std::async(std::launch::async, [&]() {
+                                const auto bedrock_path = archiver ? scratch_area->path() / "bedrock" / world_name : bedrock_output->output.path;
+
+                                auto bedrock_job = reporter.begin_job(fmt::format(L"Converting {} to Bedrock Edition...", source.name()));
+
+                                const auto [bedrock_duration, bedrock_status] = x360mse::util::run_measuring<je2be::Status>([&]() {
+                                    return x360mse::edition::convert_to_bedrock(world_path, bedrock_path, scratch_area->path() / "bedrock-temp", thread_count);
+                                });
+
+                                bedrock_job.end();
+
+                                metrics.record(source.id(), x360mse::metrics::Stage::BEDROCK_CONVERSION, bedrock_duration, source.size());
+
+                                if (bedrock_status.error()) {
+                                    fail(fmt::format(L"Failed to convert to Bedrock Edition: {}", source.name()));
+
+                                    return false;
+                                }
+
+                                if (archiver) {
+                                    pack(bedrock_path, bedrock_output->output.path);
+                                }
+
+                                return true;
+                            });
+                        }
+
+                        if (java_output) {
+                            if (archiver) {
+                                pack(world_path, java_output->output.path);
+                            }
+
+                            java_output->converted = true;
+                        }
+
+                        if (bedrock_output) {
+                            bedrock_output->converted = bedrock_conversion.get();
+                        }
+                    }
+
+                    const auto converted = std::ranges::all_of(pending_outputs, &PendingOutput::converted);
+
+                    if (converted) {
+                        journal.record(source.origin(), x360mse::journal::State::FINALIZED);
+
+                        result.outcome = SaveOutcome::CONVERTED;
+                    }
+
+                    const auto peak_memory = memory_watch.end();
+
+                    metrics.record_memory(source.id(), peak_memory);
+
+                    result.peak_memory = peak_memory;
+
+                    // A world left unconverted, e.g. as its level name or Bedrock Edition conversion failed, fails the save.
+                    reporter.emit({
+                            .type = converted ? EventType::SAVE_CONVERTED : EventType::SAVE_FAILED,
+                            .position = position,
+                            .message = converted ?
+                                    fmt::format(L"Converted {}!", source.name()) :
+                                    fmt::format(L"Failed to convert {}!", source.name()),
+                            .duration = result.duration,
+                            .memory = peak_memory,
+                    });
+                }
+            } catch (const std::exception& ex) {
+                fail(exception_message(ex));
+            }
+
+            return result;
+        }
+
+        /**
+         * Applies the timestamps of an archive item to the specified file.
+         *
+         * Only supported on Windows; does nothing elsewhere.
+         *
+         * @param file_path the file to apply the timestamps to.
+         * @param info the information of the item the file was extracted from.
+         * @param context the input the item belongs to, to report errors to.
+         */
+        void set_file_times(const std::filesystem::path& file_path, const bit7z::BitArchiveItemInfo& info, InputContext& context) {
+            try {
+#ifdef _WIN32
+                HANDLE file_handle = CreateFileW(file_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+                if (file_handle == INVALID_HANDLE_VALUE) {
+                    return;
+                }
+
+                FILETIME creation_time;
+                FILETIME last_access_time;
+                FILETIME last_write_time;
+
+                auto convert_to_filetime = [](const std::chrono::system_clock::time_point& tp) -> FILETIME {
+                    // Convert time_point to cast_time to use Windows epoch.
+                    auto cast_time = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count() / 100;  // Convert to 100-nanoseconds units.
+
+                    // Adjust for the difference between UNIX epoch and Windows epoch.
+                    // Windows epoch starts 11644473600 seconds before UNIX epoch.
+                    const auto WINDOWS_TICKS = 116444736000000000LL;
+                    cast_time += WINDOWS_TICKS;
+
+                    FILETIME file_time;
+                    file_time.dwLowDateTime = static_cast<DWORD>(cast_time);
+                    file_time.dwHighDateTime = static_cast<DWORD>(cast_time >> 32);
+
+                    return file_time;
+                };
+
+                creation_time = convert_to_filetime(info.creationTime());
+                last_access_time = convert_to_filetime(info.lastAccessTime());
+                last_write_time = convert_to_filetime(info.lastWriteTime());
+
+                if (!SetFileTime(file_handle, &creation_time, &last_access_time, &last_write_time)) {
+                    context.error(fmt::format(L"Failed to set file times!\n{}", GetLastError()));
+                }
+
+                CloseHandle(file_handle);
+#endif
+            } catch (std::exception& ex) {
+                context.error(exception_message(ex));
+            }
+        }
+
+        /**
+         * Generates the file name of an extracted save.
+         *
+         * @param item_name the name of the save file inside the archive.
+         * @param bin the save bin describing the save file, if known.
+         * @return the file name, including the title of the save if known.
+         */
+        std::wstring save_file_name(
+                const std::wstring& item_name,
+                const std::optional<je2be::xbox360::MinecraftSaveInfo::SaveBin>& bin
+                ) {
+            if (!bin.has_value()) {
+                return item_name;
+            }
+
+            return fmt::format(L"{} ({}).bin", x360mse::util::to_wstring(bin->fTitle), regex_replace(item_name, std::wregex(L"\\.bin$"), L""));
+        }
+
+        /**
+         * Reports that a save is skipped, as an earlier run already converted it.
+         *
+         * @param context the input of the save.
+         * @param name the name of the save file.
+         */
+        void report_finished(InputContext& context, const std::wstring& name) {
+            context.add_save({ name, std::nullopt, SaveOutcome::SKIPPED });
+
+            context.reporter.emit({
+                    .type = EventType::SAVE_SKIPPED,
+                    .message = fmt::format(L"Skipped {}, already converted by an earlier run!", name),
+            });
+        }
+
+        /**
+         * Reports that a save is reused from the output directory, as an earlier run already kept it there.
+         *
+         * @param context the input of the save.
+         * @param name the name of the save file.
+         * @param kept_path the save file kept by the earlier run.
+         */
+        void report_kept(const InputContext& context, const std::wstring& name, const std::filesystem::path& kept_path) {
+            context.reporter.emit({
+                    .type = EventType::SAVE_SKIPPED,
+                    .message = fmt::format(L"Reused {} from {}!", name, kept_path.wstring()),
+            });
+        }
+
+        /**
+         * Moves an item extracted from the archive into the output directory.
+         *
+         * The item must have already been extracted to a staging directory
+         * by {#extract_all_from_archive}; this only names and places it.
+         *
+         * @param staged_path the path the item was extracted to.
+         * @param output_directory the directory to move the item to.
+         * @param info the information of the extracted item.
+         * @param context the input the item belongs to.
+         * @param bin the save bin describing the item, if known.
+         * @return the path the item was moved to.
+         */
+        std::filesystem::path extract_from_archive(
+                const std::filesystem::path &staged_path,
+                const std::filesystem::path &output_directory,
+                const bit7z::BitArchiveItemInfo &info,
+                InputContext& context,
+                const std::optional<je2be::xbox360::MinecraftSaveInfo::SaveBin>& bin = std::nullopt
+                ) {
+            std::filesystem::path output_path;
+            std::error_code error;
+
+            {
+                std::lock_guard lock(reservation_mutex());
+
+                output_path = unique_path(output_directory, save_file_name(info.name(), bin));
+                std::filesystem::rename(staged_path, output_path, error);
+
+                if (error) {
+                    // Hold the name while copying outside the lock.
+                    auto stream = std::ofstream { output_path, std::ios::binary };
+
+                    if (!stream) {
+                        throw std::runtime_error("Failed to create " + output_path.string());
+                    }
+                }
+            }
+
+            if (error) {
+                // The staging directory lives in the output directory, so this should
+                // not happen; fall back to copying in case it is on another volume.
+                try {
+                    std::filesystem::copy_file(staged_path, output_path, std::filesystem::copy_options::overwrite_existing);
+                } catch (...) {
+                    std::filesystem::remove(output_path, error);
+
+                    throw;
+                }
+
+                std::filesystem::remove(staged_path);
+            }
+
+            set_file_times(output_path, info, context);
+
+            return output_path;
+        }
+
+        /**
+         * Reports and stores the save bins listed in a '_MinecraftSaveInfo' file.
+         *
+         * @param save_info_path the path of the '_MinecraftSaveInfo' file.
+         * @param bins the save bins parsed from the file.
+         * @param file_index the index of the archive in the total.
+         * @param file_total the total number of archives, if known yet.
+         * @param context the input to store the save bins in the catalog of.
+         */
+        void register_save_bins(
+                const std::filesystem::path& save_info_path,
+                const std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin>& bins,
+                size_t file_index,
+                std::optional<size_t> file_total,
+                InputContext& context
+                ) {
+            std::vector<std::wstring> details;
+
+            for (const auto& bin : bins) {
+                auto file_name = x360mse::util::to_wstring(bin.fFileName);
+                auto title = x360mse::util::to_wstring(bin.fTitle);
+
+                file_name = std::regex_replace(file_name, std::wregex(L"^ +"), L"");
+
+                details.push_back(fmt::format(L"{} {} {}", file_name, uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, title));
+            }
+
+            context.reporter.emit({
+                    .type = EventType::SAVE_INFO_FOUND,
+                    .position = x360mse::events::Position { file_index, file_total },
+                    .message = fmt::format(L"Found MinecraftSaveInfo file {} with following bins:", save_info_path.filename().wstring()),
+                    .details = std::move(details),
+            });
+
+            // Index the save bins under the folder of the file, to pair them with the save files next to it.
+            context.catalog.add_save_info(save_info_path.parent_path(), bins);
+        }
+
+        /**
+         * Reports an exception raised while reading an input, unless it was raised because the input was cancelled.
+         *
+         * @param context the input.
+         * @param ex the exception.
+         */
+        void report_exception(InputContext& context, const std::exception& ex) {
+            if (!context.cancelled()) {
+                context.error(exception_message(ex));
+            }
+        }
+
+        /**
+         * Extracts all items from the specified archive.
+         *
+         * By default, saves are extracted into memory and handed to the converter
+         * from there. If the archive is solid, every save file and every
+         * '_MinecraftSaveInfo' file is instead extracted in a single pass into a
+         * staging directory, so the archive is only decoded once.
+         *
+         * If {@code keep_bin} is set, the saves are also written to the output directory.
+         *
+         * Saves the journal marks as finished are not extracted again, and saves
+         * it marks as kept in the output directory are read from there.
+         *
+         * Archives nested in the archive, as told by their names and confirmed by
+         * their contents, are extracted into memory and searched the same way,
+         * within the nesting limits; they are never written to disk.
+         *
+         * Stops at the next save, or aborts the extraction, once the input is cancelled.
+         *
+         * @param archive_path the path to the archive; for a nested archive, the path of its outermost archive followed by its path within each archive.
+         * @param archive_buffer the contents of the archive, if it is nested and held in memory rather than read from its path.
+         * @param archive_format the format of the archive, as detected from its contents.
+         * @param nesting the limits on the archives nested in the archive.
+         * @param depth the number of archives the archive is nested in.
+         * @param output_directory the directory to extract the items to.
+         * @param lib7z the bit7z instance.
+         * @param save_file_pattern the pattern to match save files.
+         * @param file_index the index of the file in the total.
+         * @param file_total the total number of files to extract, if known yet.
+         * @param context the input, with the catalog to store the save bins found in the archive in and the journal to record the progress of each save in.
+         * @param keep_bin whether to write the extracted saves to the output directory.
+         * @param metrics the report to record the time taken by each stage in.
+         * @param sink the function to hand each save to as soon as it was extracted.
+         * @return whether the input was read without errors.
+         */
+        bool extract_all_from_archive(
+                const std::filesystem::path& archive_path,
+                const std::vector<bit7z::byte_t>* archive_buffer,
+                const bit7z::BitInFormat& archive_format,
+                const x360mse::nesting::NestingLimits& nesting,
+                unsigned int depth,
+                const std::filesystem::path& output_directory,
+                const bit7z::Bit7zLibrary& lib7z,
+                const std::wregex& minecraft_save_info_pattern,
+                const std::wregex& save_file_pattern,
+                size_t file_index,
+                std::optional<size_t> file_total,
+                InputContext& context,
+                bool keep_bin,
+                x360mse::metrics::MetricsReport& metrics,
+                const x360mse::source::SaveSink& sink
+                ) {
+            const auto& reporter = context.reporter;
+            auto& journal = *context.journal;
+            auto& catalog = context.catalog;
+
+            reporter.emit({
+                    .type = EventType::INPUT_STARTED,
+                    .position = x360mse::events::Position { file_index, file_total },
+                    .message = fmt::format(L"Processing {}...", archive_path.filename().wstring()),
+            });
+
+            try {
+                auto reader = archive_buffer ?
+                        bit7z::BitArchiveReader { lib7z, *archive_buffer, archive_format } :
+                        bit7z::BitArchiveReader { lib7z, archive_path.wstring(), archive_format };
+
+                std::vector<bit7z::BitArchiveItemInfo> save_infos;
+                std::vector<bit7z::BitArchiveItemInfo> filtered_infos;
+                std::vector<bit7z::BitArchiveItemInfo> kept_infos;
+                std::vector<bit7z::BitArchiveItemInfo> nested_infos;
+                std::vector<uint32_t> indices;
+
+                // Find the items in the archive matching save files, save info files and nested archives.
+                for (const auto& info : reader.items()) {
+                    if (info.isDir()) {
+                        continue;
+                    }
+
+                    if (std::regex_match(info.name(), save_file_pattern)) {
+                        filtered_infos.push_back(info);
+                    }
+
+                    if (std::regex_match(info.name(), minecraft_save_info_pattern)) {
+                        save_infos.push_back(info);
+                    }
+
+                    if (depth < nesting.max_depth && x360mse::nesting::is_archive_name(info.name())) {
+                        nested_infos.push_back(info);
+                    }
+                }
+
+                bool read = true;
+
+                // Search the nested archives first, one at a time, so only one of them
+                // is held in memory at each depth.
+                for (const auto& info : nested_infos) {
+                    if (context.cancelled()) {
+                        return read;
+                    }
+
+                    if (info.size() > nesting.max_size) {
+                        context.error(fmt::format(L"Nested archive is too large to open: {} ({} MiB)", info.name(), info.size() / (1024 * 1024)));
+
+                        read = false;
+                        continue;
+                    }
+
+                    std::vector<bit7z::byte_t> nested_buffer;
+                    reader.extractTo(nested_buffer, info.index());
+
+                    const auto nested_format = x360mse::format::detect(std::vector<uint8_t>(
+                            nested_buffer.begin(),
+                            nested_buffer.begin() + static_cast<std::ptrdiff_t>(std::min(nested_buffer.size(), x360mse::format::HEADER_SIZE))
+                    ));
+
+                    // Items named like archives may be anything.
+                    if (!x360mse::format::is_archive(nested_format)) {
+                        continue;
+                    }
+
+                    reporter.emit({
+                            .type = EventType::INPUT_DETECTED,
+                            .message = fmt::format(L"Detected nested {} archive {}.", x360mse::format::to_wstring(nested_format), info.name()),
+                    });
+
+                    read = extract_all_from_archive(archive_path / info.path(), &nested_buffer, x360mse::format::to_bit7z(nested_format), nesting, depth + 1, output_directory, lib7z, minecraft_save_info_pattern, save_file_pattern, file_index, file_total, context, keep_bin, metrics, sink) && read;
+                }
+
+                auto origin_of = [&](const bit7z::BitArchiveItemInfo& info) {
+                    return x360mse::journal::origin(archive_path, x360mse::util::to_utf8(info.path()), info.size(), info.crc());
+                };
+
+                // Skip the saves finished by an earlier run, and read the ones it kept from the output directory.
+                std::vector<std::string> origins;
+                std::vector<bit7z::BitArchiveItemInfo> pending_infos;
+
+                for (const auto& info : filtered_infos) {
+                    const auto origin = origin_of(info);
+
+                    origins.push_back(origin);
+
+                    if (journal.finished(origin)) {
+                        report_finished(context, info.name());
+                    } else if (keep_bin && journal.kept_save(origin, info.size())) {
+                        kept_infos.push_back(info);
+                    } else {
+                        pending_infos.push_back(info);
+                    }
+                }
+
+                journal.discover(origins);
+
+                filtered_infos = std::move(pending_infos);
+
+                if (filtered_infos.empty() && kept_infos.empty()) {
+                    return read;
+                }
+
+                for (const auto& info : save_infos) {
+                    indices.push_back(info.index());
+                }
+
+                for (const auto& info : filtered_infos) {
+                    indices.push_back(info.index());
+                }
+
+                const auto filtered_info_total = filtered_infos.size();
+
+                // Report the progress of the extraction, unless progress is not reported at all.
+                auto extraction_job = reporter.begin_job(fmt::format(L"Extracting {}...", archive_path.filename().wstring()));
+                uint64_t extraction_size = 0;
+
+                if (reporter.progress_enabled()) {
+                    // Set the total callback function for the extraction.
+                    // This function is called with the total size of the items to extract.
+                    reader.setTotalCallback([&](uint64_t total_size) {
+                        extraction_size = total_size;
+                    });
+                }
+
+                // Set the progress callback function for the extraction.
+                // This function is called with the current size of the items during extraction,
+                // and aborts it once the input is cancelled.
+                reader.setProgressCallback([&](uint64_t current_size) -> bool {
+                    if (extraction_size != 0) {
+                        extraction_job.update(static_cast<double>(current_size) / static_cast<double>(extraction_size));
+                    }
+
+                    return !context.cancelled();
+                });
+
+                auto report_extracted = [&](const bit7z::BitArchiveItemInfo& info, size_t filtered_info_index, std::chrono::nanoseconds duration) {
+                    reporter.emit({
+                            .type = EventType::SAVE_READ,
+                            .position = x360mse::events::Position { filtered_info_index, filtered_info_total },
+                            .message = keep_bin ?
+                                    fmt::format(L"Extracted {} to {}!", info.name(), output_directory.wstring()) :
+                                    fmt::format(L"Extracted {}!", info.name()),
+                            .duration = std::chrono::duration_cast<std::chrono::milliseconds>(duration),
+                    });
+                };
+
+                auto bin_of = [&](const bit7z::BitArchiveItemInfo& info) {
+                    return catalog.find_bin(std::filesystem::path(info.path()).parent_path(), info.name());
+                };
+
+                // Record the save bin of each save as it is named, so it never has to be guessed back,
+                // then hand the save over; this blocks while the conversions cannot keep up.
+                auto add_source = [&](const bit7z::BitArchiveItemInfo& info, x360mse::source::SaveSource source, const std::optional<je2be::xbox360::MinecraftSaveInfo::SaveBin>& bin, std::optional<std::chrono::nanoseconds> duration) {
+                    source.set_origin(origin_of(info));
+
+                    if (bin) {
+                        catalog.assign(source, *bin);
+                    }
+
+                    metrics.add_save(source.id(), source.name(), source.size());
+
+                    if (duration) {
+                        metrics.record(source.id(), x360mse::metrics::Stage::EXTRACTION, *duration, source.size());
+                    }
+
+                    sink(std::move(source));
+                };
+
+                if (!keep_bin && !reader.isSolid()) {
+                    // Every item of a non-solid archive can be decoded on its own,
+                    // so extract each item straight into memory.
+                    const auto temp_directory = std::filesystem::temp_directory_path();
+
+                    for (const auto& info : save_infos) {
+                        std::vector<bit7z::byte_t> buffer;
+                        reader.extractTo(buffer, info.index());
+
+
+                        // Parse the MinecraftSaveInfo file through a memory file.
+                        const auto save_info_source = x360mse::source::SaveSource::from_buffer(info.name(), { buffer.begin(), buffer.end() });
+                        const auto save_info_file = save_info_source.materialize(temp_directory);
+
+                        std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+
+                        const auto parse_duration = x360mse::util::run_measuring([&]() {
+                            je2be::xbox360::MinecraftSaveInfo::Parse(save_info_file.path(), bins);
+                        });
+
+                        metrics.record(x360mse::metrics::Stage::PARSE_SAVE_INFO, parse_duration, save_info_source.size());
+
+                        register_save_bins(info.path(), bins, file_index, file_total, context);
+                    }
+
+                    size_t filtered_info_index = 0;
+
+                    for (const auto& info : filtered_infos) {
+                        if (context.cancelled()) {
+                            return read;
+                        }
+
+                        std::vector<bit7z::byte_t> buffer;
+
+                        // Extract the item into memory and measure the time it takes.
+                        const auto duration = x360mse::util::run_measuring([&]() {
+                            reader.extractTo(buffer, info.index());
+                        });
+
+                        const auto bin = bin_of(info);
+
+                        report_extracted(info, filtered_info_index, duration);
+
+                        add_source(info, x360mse::source::SaveSource::from_buffer(save_file_name(info.name(), bin), std::move(buffer)), bin, duration);
+
+                        filtered_info_index += 1;
+                    }
+                } else {
+                    // Extract into a staging directory. When the saves are kept, it lives
+                    // next to the outputs, so items can be moved into place by renaming
+                    // them; otherwise, it is removed once the last save was converted.
+                    const auto staging_directory = keep_bin ?
+                            create_unique_directory(output_directory, L".x360mse-staging") :
+                            create_unique_directory(std::filesystem::temp_directory_path(), L"x360mse-staging");
+
+                    const auto staging_owner = std::shared_ptr<void>(nullptr, [staging_directory](void*) {
+                        std::error_code error;
+                        std::filesystem::remove_all(staging_directory, error);
+                    });
+
+                    // Record when each item starts being extracted, to time items individually.
+                    std::map<std::wstring, std::chrono::steady_clock::time_point> item_start_times;
+
+                    // Set the file callback function for the extraction.
+                    // This function is called with the path of each item as it starts being extracted.
+                    reader.setFileCallback([&](const bit7z::tstring& item_path) {
+                        auto path = std::filesystem::path(item_path);
+
+                        if (path.is_absolute()) {
+                            path = path.lexically_relative(staging_directory);
+                        }
+
+                        item_start_times[path.lexically_normal().wstring()] = std::chrono::steady_clock::now();
+                    });
+
+                    // Extract every matching item at once.
+                    const auto pass_start_time = std::chrono::steady_clock::now();
+
+                    if (!indices.empty()) {
+                        reader.extractTo(staging_directory, indices);
+                    }
+
+                    const auto extraction_end_time = std::chrono::steady_clock::now();
+
+
+                    for (const auto& info : save_infos) {
+                        std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+
+                        // Parse the MinecraftSaveInfo file from the staging directory.
+                        const auto parse_duration = x360mse::util::run_measuring([&]() {
+                            je2be::xbox360::MinecraftSaveInfo::Parse(staging_directory / info.path(), bins);
+                        });
+
+                        metrics.record(x360mse::metrics::Stage::PARSE_SAVE_INFO, parse_duration, info.size());
+
+                        register_save_bins(info.path(), bins, file_index, file_total, context);
+                    }
+
+                    // Items are extracted in archive order, so each item ends when the next one starts.
+                    std::vector<std::chrono::steady_clock::time_point> start_times;
+
+                    for (const auto& [item_path, start_time] : item_start_times) {
+                        start_times.push_back(start_time);
+                    }
+
+                    std::ranges::sort(start_times);
+
+                    auto item_duration = [&](const bit7z::BitArchiveItemInfo& info) -> std::chrono::nanoseconds {
+                        const auto start = item_start_times.find(std::filesystem::path(info.path()).lexically_normal().wstring());
+
+                        if (start == item_start_times.end()) {
+                            return std::chrono::duration_cast<std::chrono::nanoseconds>(extraction_end_time - pass_start_time);
+                        }
+
+                        const auto next = std::ranges::upper_bound(start_times, start->second);
+                        const auto end = next != start_times.end() ? *next : extraction_end_time;
+
+                        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start->second);
+                    };
+
+                    size_t filtered_info_index = 0;
+
+                    for (const auto& info : filtered_infos) {
+                        if (context.cancelled()) {
+                            return read;
+                        }
+
+                        const auto staged_path = staging_directory / info.path();
+                        const auto bin = bin_of(info);
+
+                        const auto duration = item_duration(info);
+
+                        report_extracted(info, filtered_info_index, duration);
+
+                        if (keep_bin) {
+                            // Move the item into the output directory under its final name.
+                            add_source(info, x360mse::source::SaveSource::from_file(extract_from_archive(staged_path, output_directory, info, context, bin)), bin, duration);
+                        } else {
+                            // Convert the item from the staging directory, which is kept until then.
+                            add_source(info, x360mse::source::SaveSource::from_file(staged_path, save_file_name(info.name(), bin), staging_owner), bin, duration);
+                        }
+
+                        filtered_info_index += 1;
+                    }
+                }
+
+                // Hand over the saves kept by an earlier run, now that their save bins are known.
+                for (const auto& info : kept_infos) {
+                    const auto kept_path = journal.kept_save(origin_of(info), info.size());
+
+                    report_kept(context, info.name(), *kept_path);
+
+                    add_source(info, x360mse::source::SaveSource::from_file(*kept_path), bin_of(info), std::nullopt);
+                }
+
+                return read;
+            } catch (std::exception& ex) {
+                report_exception(context, ex);
+
+                return false;
+            }
+        }
+
+        /**
+         * Copies all save files from the specified directory to the output directory.
+         *
+         * The directory is searched recursively, so the root of a mounted drive or
+         * its 'Content' folder can be given directly. Each save file is paired with
+         * the '_MinecraftSaveInfo' file found in the same folder.
+         *
+         * Files are cloned or linked rather than copied where the file system
+         * allows it. If {@code in_place} is set, they are not copied at all, and
+         * are converted from the directory.
+         *
+         * Saves the journal marks as finished are not copied again, and saves
+         * it marks as copied are read from the output directory.
+         *
+         * @param directory_path the directory to copy files from.
+         * @param output_directory the directory to copy files to.
+         * @param save_file_pattern the pattern to match save files.
+         * @param directory_index the index of the directory in the total.
+         * @param directory_total the total number of directories to copy from, if known yet.
+         * @param context the input, with the catalog to store the save bins found in the directory in and the journal to record the progress of each save in.
+         * @param thread_count the number of threads to search the directory with.
+         * @param in_place whether to convert the save files from the directory rather than copying them.
+         * @param metrics the report to record the time taken by each stage in.
+         * @param sink the function to hand each save to as soon as it was copied.
+         * @return whether the input was read without errors.
+         */
+        bool copy_all_from_directory(
+                const std::filesystem::path& directory_path,
+                const std::filesystem::path& output_directory,
+                const std::wregex& minecraft_save_info_pattern,
+                const std::wregex& save_file_pattern,
+                size_t directory_index,
+                std::optional<size_t> directory_total,
+                InputContext& context,
+                unsigned int thread_count,
+                bool in_place,
+                x360mse::metrics::MetricsReport& metrics,
+                const x360mse::source::SaveSink& sink
+                ) {
+            const auto& reporter = context.reporter;
+            auto& journal = *context.journal;
+            auto& catalog = context.catalog;
+
+            reporter.emit({
+                    .type = EventType::INPUT_STARTED,
+                    .position = x360mse::events::Position { directory_index, directory_total },
+                    .message = fmt::format(L"Processing {}...", directory_path.filename().wstring()),
+            });
+
+            try {
+                // Find all folders holding save files, walking subtrees in parallel.
+                const auto discovery = x360mse::discovery::discover(directory_path, minecraft_save_info_pattern, save_file_pattern, thread_count);
+
+                size_t filtered_path_total = 0;
+                uintmax_t filtered_path_size = 0;
+
+                // Identify each save by its path, size and modification time, to recognize it in a later run.
+                std::map<std::filesystem::path, std::string> origins;
+
+                for (const auto& save_directory : discovery.directories) {
+                    filtered_path_total += save_directory.save_files.size();
+
+                    for (const auto& path : save_directory.save_files) {
+                        std::error_code error;
+                        const auto size = std::filesystem::file_size(path, error);
+                        const auto write_time = std::filesystem::last_write_time(path, error);
+
+                        filtered_path_size += error ? 0 : size;
+
+                        origins[path] = x360mse::journal::origin(
+                                directory_path,
+                                x360mse::util::to_utf8(path.lexically_relative(directory_path).wstring()),
+                                error ? 0 : size,
+                                error ? 0 : static_cast<uint64_t>(write_time.time_since_epoch().count())
+                        );
+                    }
+                }
+
+                metrics.record(x360mse::metrics::Stage::DISCOVERY, discovery.duration, filtered_path_size);
+
+                std::vector<std::string> discovered_origins;
+
+                for (const auto& [path, origin] : origins) {
+                    discovered_origins.push_back(origin);
+                }
+
+                journal.discover(discovered_origins);
+
+                reporter.emit({
+                        .type = EventType::SAVES_DISCOVERED,
+                        .position = x360mse::events::Position { directory_index, directory_total },
+                        .message = fmt::format(L"Found {} save file(s) in {} folder(s), out of {} searched!", filtered_path_total, discovery.directories.size(), discovery.directories_scanned),
+                        .duration = std::chrono::duration_cast<std::chrono::milliseconds>(discovery.duration),
+                });
+
+                size_t filtered_path_index = 0;
+
+                for (const auto& save_directory : discovery.directories) {
+                    // Pair the save files with the save bins of their own folder, as
+                    // different profiles may use the same save file names.
+                    if (save_directory.save_info_file) {
+                        std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+
+                        const auto parse_duration = x360mse::util::run_measuring([&]() {
+                            je2be::xbox360::MinecraftSaveInfo::Parse(*save_directory.save_info_file, bins);
+                        });
+
+                        std::error_code error;
+                        const auto save_info_size = std::filesystem::file_size(*save_directory.save_info_file, error);
+
+                        metrics.record(x360mse::metrics::Stage::PARSE_SAVE_INFO, parse_duration, error ? 0 : save_info_size);
+
+                        catalog.add_save_info(save_directory.directory, bins);
+                    }
+
+                    for (const auto& path : save_directory.save_files) {
+                        if (context.cancelled()) {
+                            return true;
+                        }
+
+                        const auto& origin = origins[path];
+
+                        if (journal.finished(origin)) {
+                            report_finished(context, path.filename().wstring());
+
+                            filtered_path_index += 1;
+                            continue;
+                        }
+
+                        const auto bin = catalog.find_bin(save_directory.directory, path.filename().wstring());
+
+                        std::error_code error;
+                        const auto kept_path = in_place ? std::nullopt : journal.kept_save(origin, std::filesystem::file_size(path, error));
+
+                        std::optional<x360mse::source::SaveSource> source;
+                        std::optional<x360mse::copy::CopyMethod> copy_method;
+
+                        // Copy the file to the output directory, unless converted in place or
+                        // already copied by an earlier run, and measure the time it takes.
+                        const auto duration = x360mse::util::run_measuring([&]() {
+                            if (in_place) {
+                                source = x360mse::source::SaveSource::from_file(path, save_file_name(path.filename().wstring(), bin));
+                            } else if (kept_path) {
+                                source = x360mse::source::SaveSource::from_file(*kept_path);
+                            } else {
+                                const auto [output_path, method] = copy_to_unique_path(path, output_directory, save_file_name(path.filename().wstring(), bin));
+
+                                copy_method = method;
+                                source = x360mse::source::SaveSource::from_file(output_path);
+                            }
+                        });
+
+                        source->set_origin(origin);
+
+                        // Record the save bin of the save as it is named, so it never has to be guessed back.
+                        if (bin) {
+                            catalog.assign(*source, *bin);
+                        }
+
+                        metrics.add_save(source->id(), source->name(), source->size());
+
+                        if (copy_method) {
+                            metrics.record(source->id(), x360mse::metrics::Stage::COPY, duration, source->size());
+                        }
+
+                        reporter.emit({
+                                .type = EventType::SAVE_READ,
+                                .position = x360mse::events::Position { filtered_path_index, filtered_path_total },
+                                .message = copy_method ? fmt::format(L"{} {} to {}!", x360mse::copy::to_wstring(*copy_method), path.filename().wstring(), output_directory.wstring()) :
+                                        kept_path ? fmt::format(L"Reused {} from {}!", path.filename().wstring(), kept_path->wstring()) :
+                                        fmt::format(L"Reading {} in place!", path.filename().wstring()),
+                                .duration = std::chrono::duration_cast<std::chrono::milliseconds>(duration),
+                        });
+
+                        // Hand the save over; this blocks while the conversions cannot keep up.
+                        sink(std::move(*source));
+
+                        filtered_path_index += 1;
+                    }
+                }
+
+                return true;
+            } catch (std::exception& ex) {
+                report_exception(context, ex);
+
+                return false;
+            }
+        }
+
+        /**
+         * Reads all save files from the specified Xbox 360 disk image.
+         *
+         * The image is mapped into memory and its FATX directory tables are walked
+         * in place, so no third-party tool is needed to mount it. Save files are
+         * handed to the converter as views into the mapping, unless they are
+         * fragmented, in which case their clusters are gathered into memory.
+         * Each save file is paired with the '_MinecraftSaveInfo' file found in
+         * the same folder.
+         *
+         * If {@code keep_bin} is set, the saves are also written to the output directory.
+         *
+         * Saves the journal marks as finished are not read again, and saves
+         * it marks as kept in the output directory are read from there.
+         *
+         * @param image_path the path to the disk image.
+         * @param output_directory the directory to write the saves to, if kept.
+         * @param minecraft_save_info_pattern the pattern to match '_MinecraftSaveInfo' files.
+         * @param save_file_pattern the pattern to match save files.
+         * @param file_index the index of the image in the total.
+         * @param file_total the total number of inputs, if known yet.
+         * @param context the input, with the catalog to store the save bins found in the image in and the journal to record the progress of each save in.
+         * @param keep_bin whether to write the saves to the output directory.
+         * @param metrics the report to record the time taken by each stage in.
+         * @param sink the function to hand each save to as soon as it was read.
+         * @return whether the input was read without errors.
+         */
+        bool read_all_from_image(
+                const std::filesystem::path& image_path,
+                const std::filesystem::path& output_directory,
+                const std::wregex& minecraft_save_info_pattern,
+                const std::wregex& save_file_pattern,
+                size_t file_index,
+                std::optional<size_t> file_total,
+                InputContext& context,
+                bool keep_bin,
+                x360mse::metrics::MetricsReport& metrics,
+                const x360mse::source::SaveSink& sink
+                ) {
+            const auto& reporter = context.reporter;
+            auto& journal = *context.journal;
+            auto& catalog = context.catalog;
+
+            reporter.emit({
+                    .type = EventType::INPUT_STARTED,
+                    .position = x360mse::events::Position { file_index, file_total },
+                    .message = fmt::format(L"Processing {}...", image_path.filename().wstring()),
+            });
+
+            try {
+                const auto image = x360mse::fatx::FatxImage::open(image_path);
+
+                std::vector<x360mse::fatx::File> save_infos;
+                std::vector<x360mse::fatx::File> save_files;
+
+                // Walk the directory tables of every partition for save files and save info files.
+                const auto discovery_duration = x360mse::util::run_measuring([&]() {
+                    for (auto& file : image->list_files([&](const std::string& name) {
+                        const auto wide_name = x360mse::util::to_wstring(name);
+
+                        return std::regex_match(wide_name, save_file_pattern) || std::regex_match(wide_name, minecraft_save_info_pattern);
+                    })) {
+                        const auto name = x360mse::util::to_wstring(std::filesystem::path(file.path).filename().string());
+
+                        if (std::regex_match(name, minecraft_save_info_pattern)) {
+                            save_infos.push_back(std::move(file));
+                        } else {
+                            save_files.push_back(std::move(file));
+                        }
+                    }
+                });
+
+                uintmax_t save_files_size = 0;
+
+                // Identify each save by its path, size and first cluster, to recognize it in a later run.
+                auto origin_of = [&](const x360mse::fatx::File& file) {
+                    return x360mse::journal::origin(image_path, fmt::format("{}:{}", file.partition, file.path), file.size, file.first_cluster);
+                };
+
+                std::vector<std::string> origins;
+
+                for (const auto& file : save_files) {
+                    save_files_size += file.size;
+                    origins.push_back(origin_of(file));
+                }
+
+                journal.discover(origins);
+
+                metrics.record(x360mse::metrics::Stage::DISCOVERY, discovery_duration, save_files_size);
+
+                reporter.emit({
+                        .type = EventType::SAVES_DISCOVERED,
+                        .position = x360mse::events::Position { file_index, file_total },
+                        .message = fmt::format(L"Found {} save file(s) in {} partition(s)!", save_files.size(), image->partitions().size()),
+                        .duration = std::chrono::duration_cast<std::chrono::milliseconds>(discovery_duration),
+                });
+
+                // View a file in place where possible, and gather its clusters otherwise.
+                auto source_of = [&](const x360mse::fatx::File& file, std::wstring name) {
+                    if (const auto view = image->view(file)) {
+                        return x360mse::source::SaveSource::from_view(std::move(name), *view, image);
+                    }
+
+                    return x360mse::source::SaveSource::from_buffer(std::move(name), image->read(file));
+                };
+
+                const auto temp_directory = std::filesystem::temp_directory_path();
+
+                for (const auto& file : save_infos) {
+                    const auto save_info_path = std::filesystem::path(x360mse::util::to_wstring(file.path));
+
+                    // Parse the MinecraftSaveInfo file through a memory file.
+                    const auto save_info_source = source_of(file, save_info_path.filename().wstring());
+                    const auto save_info_file = save_info_source.materialize(temp_directory);
+
+                    std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+
+                    const auto parse_duration = x360mse::util::run_measuring([&]() {
+                        je2be::xbox360::MinecraftSaveInfo::Parse(save_info_file.path(), bins);
+                    });
+
+                    metrics.record(x360mse::metrics::Stage::PARSE_SAVE_INFO, parse_duration, save_info_source.size());
+
+                    register_save_bins(save_info_path, bins, file_index, file_total, context);
+                }
+
+                size_t save_file_index = 0;
+
+                for (const auto& file : save_files) {
+                    if (context.cancelled()) {
+                        return true;
+                    }
+
+                    const auto save_path = std::filesystem::path(x360mse::util::to_wstring(file.path));
+                    const auto origin = origin_of(file);
+
+                    if (journal.finished(origin)) {
+                        report_finished(context, save_path.filename().wstring());
+
+                        save_file_index += 1;
+                        continue;
+                    }
+
+                    const auto bin = catalog.find_bin(save_path.parent_path(), save_path.filename().wstring());
+
+                    if (const auto kept_path = keep_bin ? journal.kept_save(origin, file.size) : std::nullopt) {
+                        // Read the save kept in the output directory by an earlier run.
+                        auto source = x360mse::source::SaveSource::from_file(*kept_path);
+                        source.set_origin(origin);
+
+                        if (bin) {
+                            catalog.assign(source, *bin);
+                        }
+
+                        metrics.add_save(source.id(), source.name(), source.size());
+
+                        report_kept(context, save_path.filename().wstring(), *kept_path);
+
+                        sink(std::move(source));
+
+                        save_file_index += 1;
+                        continue;
+                    }
+
+                    std::optional<x360mse::source::SaveSource> source;
+
+                    const auto duration = x360mse::util::run_measuring([&]() {
+                        source = source_of(file, save_file_name(save_path.filename().wstring(), bin));
+
+                        if (keep_bin) {
+                            // Write the save to the output directory under its final name.
+                            const auto output_path = reserve_file(output_directory, source->name());
+
+                            auto stream = std::ofstream { output_path, std::ios::binary };
+                            stream.write(reinterpret_cast<const char*>(source->data().data()), static_cast<std::streamsize>(source->size()));
+
+                            if (!stream) {
+                                throw std::runtime_error("Failed to write " + output_path.string());
+                            }
+
+                            stream.close();
+                            source = x360mse::source::SaveSource::from_file(output_path);
+                        }
+                    });
+
+                    source->set_origin(origin);
+
+                    // Record the save bin of the save as it is named, so it never has to be guessed back.
+                    if (bin) {
+                        catalog.assign(*source, *bin);
+                    }
+
+                    metrics.add_save(source->id(), source->name(), source->size());
+                    metrics.record(source->id(), x360mse::metrics::Stage::EXTRACTION, duration, source->size());
+
+                    reporter.emit({
+                            .type = EventType::SAVE_READ,
+                            .position = x360mse::events::Position { save_file_index, save_files.size() },
+                            .message = keep_bin ?
+                                    fmt::format(L"Read {} to {}!", save_path.filename().wstring(), output_directory.wstring()) :
+                                    fmt::format(L"Read {}!", save_path.filename().wstring()),
+                            .duration = std::chrono::duration_cast<std::chrono::milliseconds>(duration),
+                    });
+
+                    // Hand the save over; this blocks while the conversions cannot keep up.
+                    sink(std::move(*source));
+
+                    save_file_index += 1;
+                }
+
+                return true;
+            } catch (std::exception& ex) {
+                report_exception(context, ex);
+
+                return false;
+            }
+        }
+
+        /**
+         * Copies the specified file to the output directory.
+         *
+         * The file is not copied again if the journal marks it as finished or copied.
+         * It is cloned or linked rather than copied where the file system allows it,
+         * and not copied at all if {@code in_place} is set.
+         *
+         * @param file_path the file to copy.
+         * @param output_directory the directory to copy the file to.
+         * @param in_place whether to convert the file where it is rather than copying it.
+         * @param context the input, with the journal to record the progress of the save in.
+         * @param metrics the report to record the time taken by the copy in.
+         * @param sink the function to hand the save to, if it is not finished yet.
+         * @return whether the file was read without errors.
+         */
+        bool copy_file_(
+                const std::filesystem::path& file_path,
+                const std::filesystem::path& output_directory,
+                bool in_place,
+                InputContext& context,
+                x360mse::metrics::MetricsReport& metrics,
+                const x360mse::source::SaveSink& sink
+                ) {
+            auto& journal = *context.journal;
+
+            try {
+                const auto file_size = std::filesystem::file_size(file_path);
+                const auto origin = x360mse::journal::origin(file_path, {}, file_size, static_cast<uint64_t>(std::filesystem::last_write_time(file_path).time_since_epoch().count()));
+
+                journal.discover({ origin });
+
+                if (journal.finished(origin)) {
+                    report_finished(context, file_path.filename().wstring());
+
+                    return true;
+                }
+
+                if (in_place) {
+                    auto source = x360mse::source::SaveSource::from_file(file_path);
+                    source.set_origin(origin);
+
+                    metrics.add_save(source.id(), source.name(), source.size());
+
+                    sink(std::move(source));
+
+                    return true;
+                }
+
+                const auto kept_path = journal.kept_save(origin, file_size);
+
+                if (kept_path) {
+                    auto source = x360mse::source::SaveSource::from_file(*kept_path);
+                    source.set_origin(origin);
+
+                    metrics.add_save(source.id(), source.name(), source.size());
+
+                    report_kept(context, file_path.filename().wstring(), *kept_path);
+
+                    sink(std::move(source));
+
+                    return true;
+                }
+
+                // Copy the file to the output directory and measure the time it takes.
+                std::filesystem::path output_path;
+                auto copy_method = x360mse::copy::CopyMethod::COPY;
+
+                const auto duration = x360mse::util::run_measuring([&]() {
+                    std::tie(output_path, copy_method) = copy_to_unique_path(file_path, output_directory, file_path.filename());
+                });
+
+                auto source = x360mse::source::SaveSource::from_file(output_path);
+                source.set_origin(origin);
+
+                metrics.add_save(source.id(), source.name(), source.size());
+                metrics.record(source.id(), x360mse::metrics::Stage::COPY, duration, source.size());
+
+                context.reporter.emit({
+                        .type = EventType::SAVE_READ,
+                        .position = x360mse::events::Position { 0, 1 },
+                        .message = fmt::format(L"{} {} to {}!", x360mse::copy::to_wstring(copy_method), file_path.filename().wstring(), output_directory.wstring()),
+                        .duration = std::chrono::duration_cast<std::chrono::milliseconds>(duration),
+                });
+
+                sink(std::move(source));
+
+                return true;
+            } catch (std::exception& ex) {
+                report_exception(context, ex);
+
+                return false;
+            }
+        }
+
+        /**
+         * @param thread_total the requested number of threads; zero for all cores.
+         * @return the number of threads shared by all conversions.
+         */
+        unsigned int resolve_thread_total(unsigned int thread_total) {
+            return thread_total != 0 ? thread_total : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /**
+         * Resolves the number of concurrent conversions. By default, a quarter
+         * of the threads is given to each conversion, as most saves cannot keep
+         * more threads than that busy.
+         *
+         * @param job_total the requested number of jobs; zero for automatic.
+         * @param thread_total the number of threads shared by all conversions.
+         * @return the number of saves converted at once.
+         */
+        unsigned int resolve_job_total(unsigned int job_total, unsigned int thread_total) {
+            return job_total != 0 ? job_total : std::max(1u, thread_total / 4);
+        }
+    }
+
+    /**
+     * The resources shared by every input of a converter, and the threads reading them.
+     *
+     * Members are declared in the order they are needed, so the scheduler
+     * is destroyed before the resources its conversions use.
+     */
+    struct Converter::State {
+        ConverterOptions options;
+
+        unsigned int thread_total;
+        unsigned int job_total;
+
+        bit7z::Bit7zLibrary lib7z;
+
+        const std::wregex minecraft_save_info_pattern { LR"(_MinecraftSaveInfo)" };
+        const std::wregex save_file_pattern { LR"(Save(.+)\.bin)" };
+
+        x360mse::metrics::MetricsReport metrics;
+
+        x360mse::cache::ConversionCache cache;
+
+        // Measure the memory each conversion takes, and only start conversions
+        // while their expected footprints fit in the memory limit, if any.
+        x360mse::governor::MemoryGovernor governor;
+
+        // Share scratch folders between conversions; declared before the
+        // scheduler, so they outlive every conversion. Folders in memory
+        // count against the memory limit.
+        x360mse::scratch::ScratchSpace scratch;
+
+        // Pack converted worlds into archives, if requested.
+        std::optional<x360mse::archive::WorldArchiver> archiver;
+
+        // Record the progress of each save, so an interrupted run can be resumed.
+        // Inputs converted into the same output folder share its journal,
+        // which is opened when the first of them is read.
+        std::string journal_settings;
+        std::map<std::filesystem::path, std::unique_ptr<x360mse::journal::Journal>> journals;
+        std::mutex journal_mutex;
+
+        std::atomic<size_t> count = 0;
+        std::atomic<size_t> source_total = 0;
+
+        // Convert saves while the next ones are still being extracted or copied.
+        // Only a couple of saves per job may wait for a conversion; past that,
+        // reading the inputs is held back until the conversions catch up.
+        // Every input shares the same queue, so a single converter keeps every
+        // core busy across inputs.
+        x360mse::scheduler::ConversionScheduler scheduler;
+
+        // Inputs are read as they are submitted, by up to one reader per job.
+        x360mse::batch::InputQueue queue;
+        std::map<size_t, std::shared_ptr<InputContext>> submitted;
+        std::mutex submit_mutex;
+        bool closed = false;
+
+        std::vector<std::thread> readers;
+
+        explicit State(ConverterOptions converter_options)
+                : options(std::move(converter_options)),
+                  thread_total(resolve_thread_total(options.thread_total)),
+                  job_total(resolve_job_total(options.job_total, thread_total)),
+                  lib7z(options.library_path.native()),
+                  cache(options.cache_directory, X360MSE_CONVERTER_VERSION),
+                  governor(options.max_memory),
+                  scratch(options.scratch_directory.value_or(std::filesystem::temp_directory_path()), options.scratch_memory, &governor),
+                  scheduler(job_total, thread_total, static_cast<size_t>(job_total) * 2, &governor) {
+            if (options.output_format) {
+                archiver.emplace(lib7z, *options.output_format);
+            }
+
+            journal_settings = options.overrides.fingerprint() + options.selection.fingerprint() + (options.output_format ? x360mse::util::to_utf8(x360mse::archive::extension(*options.output_format)) : "");
+
+            for (const auto edition : options.editions) {
+                journal_settings += std::string("|") + x360mse::edition::to_string(edition);
+            }
+
+            // Read several inputs at once, so reading an input overlaps with
+            // reading the others, not only with converting their saves.
+            for (unsigned int reader_index = 0; reader_index < job_total; reader_index += 1) {
+                readers.emplace_back([this]() {
+                    while (auto taken = queue.pop()) {
+                        std::shared_ptr<InputContext> context;
+
+                        {
+                            std::lock_guard lock(submit_mutex);
+                            context = std::move(submitted.extract(taken->index).mapped());
+                        }
+
+                        if (!context->cancelled()) {
+                            try {
+                                context->journal = &journal_of(*context);
+                                context->read = read_input(context);
+                            } catch (const std::exception& ex) {
+                                context->error(exception_message(ex));
+                            }
+                        }
+
+                        release(context);
+                    }
+                });
+            }
+        }
+
+        /**
+         * Opens the journal of the output folder of an input, if not opened yet.
+         *
+         * @param context the input.
+         * @return the journal.
+         */
+        x360mse::journal::Journal& journal_of(const InputContext& context) {
+            const auto& output_directory = context.input.output_directory;
+
+            std::lock_guard lock(journal_mutex);
+
+            if (!std::filesystem::exists(output_directory)) {
+                // Create the output directory if it does not exist.
+                std::filesystem::create_directories(output_directory);
+            }
+
+            auto& journal = journals[std::filesystem::weakly_canonical(output_directory)];
+
+            if (!journal) {
+                journal = std::make_unique<x360mse::journal::Journal>(output_directory, journal_settings, options.resume);
+
+                if (options.resume) {
+                    context.reporter.emit({
+                            .type = EventType::RUN_RESUMED,
+                            .message = journal->resumed_count() > 0 ?
+                                    fmt::format(L"Resuming a run of {} save(s) into {}.", journal->resumed_count(), output_directory.wstring()) :
+                                    fmt::format(L"No run into {} to resume with the same settings; starting over.", output_directory.wstring()),
+                    });
+                }
+            }
+
+            return *journal;
+        }
+
+        /**
+         * Called once the input was read, and once each of its saves was converted;
+         * hands over the result of the input once nothing of it is running anymore.
+         *
+         * @param context the input.
+         */
+        void release(const std::shared_ptr<InputContext>& context) {
+            if (--context->outstanding != 0) {
+                return;
+            }
+
+            auto result = context->result();
+
+            context->reporter.emit({ .type = EventType::INPUT_FINISHED, .message = context->input.path.wstring() });
+
+            // Hand over the result before calling the handler, so waiting on it never depends on the handler.
+            context->promise.set_value(result);
+
+            if (context->on_result) {
+                try {
+                    context->on_result(result);
+                } catch (const std::exception& ex) {
+                    context->reporter.error(exception_message(ex));
+                }
+            }
+        }
+
+        /**
+         * Queues a save for conversion as soon as it is read; called from the
+         * thread reading its input, so output names are reserved in order.
+         *
+         * @param context the input of the save.
+         * @param source the save.
+         */
+        void submit_source(const std::shared_ptr<InputContext>& context, x360mse::source::SaveSource source) {
+            if (context->cancelled()) {
+                context->add_save({ source.name(), std::nullopt, SaveOutcome::CANCELLED });
+
+                return;
+            }
+
+            const auto& editions = options.editions;
+            const auto& output_directory = context->input.output_directory;
+            auto& journal = *context->journal;
+
+            const auto save_name = std::filesystem::path(source.name());
+            auto output_name = save_name.stem();
+
+            if (archiver) {
+                output_name += x360mse::archive::extension(archiver->format());
+            }
+
+            // Reuse the output reserved by an interrupted run rather than naming a new one next to it.
+            // Its contents are only kept if the world was converted into it, and only lacks its 'level.dat' edits.
+            const auto entry = journal.find(source.origin());
+            const auto reserved = entry && !entry->output_path.empty();
+            const auto state = reserved && !archiver && entry->state == x360mse::journal::State::CONVERTED ?
+                    x360mse::journal::State::CONVERTED :
+                    x360mse::journal::State::EXTRACTED;
+
+            std::filesystem::path save_output_path;
+            std::vector<x360mse::edition::Output> outputs;
+
+            {
+                std::lock_guard lock(reservation_mutex());
+
+                save_output_path = reserved ?
+                        entry->output_path :
+                        std::filesystem::path(unique_path(output_directory, output_name));
+
+                // Name the worlds of the other editions after the world of the first one.
+                for (const auto edition : editions) {
+                    auto edition_output_path = x360mse::edition::output_path(save_output_path, edition, editions.front());
+
+                    if (edition != editions.front() && !reserved) {
+                        edition_output_path = unique_path(output_directory, edition_output_path.filename());
+                    }
+
+                    outputs.push_back({ edition, edition_output_path });
+                }
+
+                for (const auto& output : outputs) {
+                    if (reserved && state != x360mse::journal::State::CONVERTED) {
+                        std::filesystem::remove_all(output.path);
+                    }
+
+                    // Create the world's output directory, or reserve the name of its archive.
+                    if (archiver) {
+                        std::ofstream { output.path };
+                    } else {
+                        std::filesystem::create_directories(output.path);
+                    }
+                }
+            }
+
+            // Convert the Minecraft Xbox 360 Edition save file to a Minecraft Java Edition save file.
+            const auto save_bin = context->catalog.resolve(source);
+
+            if (!save_bin) {
+                const auto message = fmt::format(L"Could not find save bin for file: {}", save_name.wstring());
+
+                for (const auto& output : outputs) {
+                    discard_output(output.path);
+                }
+
+                context->add_save({ source.name(), std::nullopt, SaveOutcome::FAILED, outputs, {}, 0, { message } });
+                context->reporter.error(message);
+
+                return;
+            }
+
+            const auto save_size = source.size();
+
+            source_total += 1;
+            context->outstanding += 1;
+
+            // Remember the output of the save, and the save file if it was kept next to it.
+            const auto kept = !source.in_memory() && source.path()->parent_path() == output_directory;
+
+            journal.record(source.origin(), state, kept ? *source.path() : std::filesystem::path(), save_output_path);
+
+            // Saves held in a buffer of their own take memory until they were converted.
+            const auto held_size = source.buffered() ? save_size : 0;
+
+            governor.hold(held_size);
+
+            // Move the source into the task, so saves held in memory are
+            // released as soon as they were converted. The total is only
+            // known once every input was read, so the saves queued so
+            // far are reported instead.
+            scheduler.submit(save_size, [this, context, source = std::move(source), outputs = std::move(outputs), bin = *save_bin, held_size](unsigned int thread_count) {
+                defer {
+                    governor.drop(held_size);
+                    release(context);
+                };
+
+                if (context->cancelled()) {
+                    for (const auto& output : outputs) {
+                        discard_output(output.path);
+                    }
+
+                    context->add_save({ source.name(), title_of(bin.fTitle), SaveOutcome::CANCELLED, outputs });
+
+                    return;
+                }
+
+                context->add_save(convert_file(source, outputs, count++, source_total.load(), bin, thread_count, cache, metrics, scratch, options.overrides, options.selection, archiver, *context, governor));
+            });
+        }
+
+        /**
+         * Reads an input, handing each of its saves to the conversion queue.
+         *
+         * @param context the input.
+         * @return whether the input was read without errors.
+         */
+        bool read_input(const std::shared_ptr<InputContext>& context) {
+            const auto& input_path = context->input.path;
+            const auto& output_directory = context->input.output_directory;
+            const auto input_index = context->index;
+            // While inputs are still being submitted, their total is not known yet.
+            const auto input_total = queue.total();
+
+            const auto sink = [&](x360mse::source::SaveSource source) {
+                submit_source(context, std::move(source));
+            };
+
+            // Identify the input file from its contents rather than its extension.
+            const auto input_format = std::filesystem::is_regular_file(input_path) ?
+                    x360mse::format::detect(input_path) :
+                    x360mse::format::InputFormat::UNKNOWN;
+
+            if (std::filesystem::is_directory(input_path)) {
+                // If the input path is a directory, copy all save files from the directory to the output directory.
+                return copy_all_from_directory(input_path, output_directory, minecraft_save_info_pattern, save_file_pattern, input_index, input_total, *context, thread_total, options.in_place, metrics, sink);
+            }
+
+            if (input_format == x360mse::format::InputFormat::SAVE_BIN) {
+                // If the input path is a save file, copy the save file to the output directory.
+                return copy_file_(input_path, output_directory, options.in_place, *context, metrics, sink);
+            }
+
+            if (x360mse::format::is_archive(input_format)) {
+                // If the input path is a compressed archive, extract all save files from the archive.
+                context->reporter.emit({
+                        .type = EventType::INPUT_DETECTED,
+                        .message = fmt::format(L"Detected {} archive.", x360mse::format::to_wstring(input_format)),
+                });
+
+                return extract_all_from_archive(input_path, nullptr, x360mse::format::to_bit7z(input_format), options.nesting, 0, output_directory, lib7z, minecraft_save_info_pattern, save_file_pattern, input_index, input_total, *context, options.keep_bin, metrics, sink);
+            }
+
+            if (std::filesystem::is_regular_file(input_path) && x360mse::fatx::FatxImage::is_image(input_path)) {
+                // If the input path is a raw disk image, read all save files from its FATX partitions.
+                context->reporter.emit({
+                        .type = EventType::INPUT_DETECTED,
+                        .message = L"Detected Xbox 360 disk image.",
+                });
+
+                return read_all_from_image(input_path, output_directory, minecraft_save_info_pattern, save_file_pattern, input_index, input_total, *context, options.keep_bin, metrics, sink);
+            }
+
+            context->error(fmt::format(L"{}: {}", std::filesystem::is_regular_file(input_path) ?
+                    L"Input file is neither a save file nor a supported archive" :
+                    L"Input path is not a file or directory", input_path.wstring()));
+
+            return false;
+        }
+    };
+
+    Converter::Converter(ConverterOptions options) : state_(std::make_unique<State>(std::move(options))) {}
+
+    Converter::~Converter() {
+        try {
+            close();
+        } catch (...) {
+            // Exceptions can only be reported through 'close'.
+        }
+    }
+
+    Submission Converter::submit(x360mse::batch::Input input, x360mse::events::EventHandler on_event, ResultHandler on_result) {
+        auto context = std::make_shared<InputContext>();
+        std::stop_source stop;
+
+        context->input = input;
+        context->on_result = std::move(on_result);
+        context->stop = stop.get_token();
+
+        auto result = context->promise.get_future().share();
+
+        {
+            std::lock_guard lock(state_->submit_mutex);
+
+            if (state_->closed) {
+                throw std::logic_error("Cannot submit inputs to a closed converter");
+            }
+
+            // Inputs are taken from the queue in the order they are pushed, so the
+            // index of an input is the number of inputs pushed before it.
+            context->index = state_->queue.pushed_count();
+            context->reporter = x360mse::events::Reporter { std::move(on_event), context->index, state_->options.report_progress };
+
+            state_->submitted[context->index] = context;
+            state_->queue.push(std::move(input));
+        }
+
+        return { std::move(result), std::move(stop) };
+    }
+
+    void Converter::close() {
+        {
+            std::lock_guard lock(state_->submit_mutex);
+
+            if (state_->closed) {
+                return;
+            }
+
+            state_->closed = true;
+        }
+
+        state_->queue.close();
+
+        for (auto& reader : state_->readers) {
+            reader.join();
+        }
+
+        state_->scheduler.wait();
+    }
+
+    x360mse::metrics::MetricsReport& Converter::metrics() {
+        return state_->metrics;
+    }
+
+    std::vector<x360mse::inventory::SaveEntry> list_archive(const std::filesystem::path& archive_path, const std::filesystem::path& library_path) {
+        const auto archive_format = std::filesystem::is_regular_file(archive_path) ?
+                x360mse::format::detect(archive_path) :
+                x360mse::format::InputFormat::UNKNOWN;
+
+        if (!x360mse::format::is_archive(archive_format)) {
+            throw std::invalid_argument("Only archives can be listed: " + x360mse::util::to_utf8(archive_path.wstring()));
+        }
+
+        const auto minecraft_save_info_pattern = std::wregex { LR"(_MinecraftSaveInfo)" };
+        const auto save_file_pattern = std::wregex { LR"(Save(.+)\.bin)" };
+
+        bit7z::Bit7zLibrary lib7z { library_path.native() };
+
+        auto reader = bit7z::BitArchiveReader { lib7z, archive_path.wstring(), x360mse::format::to_bit7z(archive_format) };
+
+        std::vector<bit7z::BitArchiveItemInfo> save_infos;
+        std::vector<bit7z::BitArchiveItemInfo> filtered_infos;
+
+        for (const auto& info : reader.items()) {
+            if (info.isDir()) {
+                continue;
+            }
+
+            if (std::regex_match(info.name(), save_file_pattern)) {
+                filtered_infos.push_back(info);
+            }
+
+            if (std::regex_match(info.name(), minecraft_save_info_pattern)) {
+                save_infos.push_back(info);
+            }
+        }
+
+        x360mse::catalog::SaveCatalog catalog;
+
+        const auto temp_directory = std::filesystem::temp_directory_path();
+
+        for (const auto& info : save_infos) {
+            std::vector<bit7z::byte_t> buffer;
+            reader.extractTo(buffer, info.index());
+
+            // Parse the MinecraftSaveInfo file through a memory file.
+            const auto save_info_source = x360mse::source::SaveSource::from_buffer(info.name(), { buffer.begin(), buffer.end() });
+            const auto save_info_file = save_info_source.materialize(temp_directory);
+
+            std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+            je2be::xbox360::MinecraftSaveInfo::Parse(save_info_file.path(), bins);
+
+            catalog.add_save_info(std::filesystem::path(info.path()).parent_path(), bins);
+        }
+
+        std::vector<x360mse::inventory::SaveEntry> saves;
+
+        for (const auto& info : filtered_infos) {
+            const auto bin = catalog.find_bin(std::filesystem::path(info.path()).parent_path(), info.name());
+
+            saves.push_back({
+                    bin ? std::make_optional(title_of(bin->fTitle)) : std::nullopt,
+                    info.name(),
+                    info.path(),
+                    info.packSize(),
+                    info.size(),
+                    info.creationTime(),
+                    info.lastWriteTime(),
+            });
+        }
+
+        return saves;
+    }
+}
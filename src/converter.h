@@ -0,0 +1,317 @@
+#ifndef X360MSE_CONVERTER_H
+#define X360MSE_CONVERTER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+#include "batch.h"
+#include "edition.h"
+#include "events.h"
+#include "inventory.h"
+#include "level.h"
+#include "metrics.h"
+#include "nesting.h"
+#include "selection.h"
+
+namespace x360mse::converter {
+    /**
+     * What became of a save.
+     */
+    enum class SaveOutcome {
+        // Every world of the save was converted.
+        CONVERTED,
+        // The worlds converted from an identical save were reused.
+        REUSED,
+        // The world converted by an interrupted run only had its 'level.dat' updated.
+        RESUMED,
+        // An earlier run already converted the save; it was not read again.
+        SKIPPED,
+        // A world of the save could not be written.
+        FAILED,
+        // The input was cancelled before the save was converted.
+        CANCELLED,
+    };
+
+    /**
+     * @param outcome the outcome to name.
+     * @return the name of the outcome, e.g. for reports.
+     */
+    inline const char* to_string(SaveOutcome outcome) {
+        switch (outcome) {
+            case SaveOutcome::CONVERTED: return "converted";
+            case SaveOutcome::REUSED: return "reused";
+            case SaveOutcome::RESUMED: return "resumed";
+            case SaveOutcome::SKIPPED: return "skipped";
+            case SaveOutcome::FAILED: return "failed";
+            case SaveOutcome::CANCELLED: return "cancelled";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * What became of a save of an input.
+     */
+    struct SaveResult {
+        std::wstring name;
+
+        /**
+         * The title of the world, if a '_MinecraftSaveInfo' file lists the save.
+         */
+        std::optional<std::string> title;
+
+        SaveOutcome outcome = SaveOutcome::FAILED;
+
+        /**
+         * The worlds written for the save, by edition.
+         */
+        std::vector<x360mse::edition::Output> outputs;
+
+        /**
+         * The time the conversion took; zero if the save was not converted.
+         */
+        std::chrono::milliseconds duration { 0 };
+
+        /**
+         * The peak memory the conversion took, in bytes; zero if unknown.
+         */
+        uint64_t peak_memory = 0;
+
+        /**
+         * What went wrong, if anything.
+         */
+        std::vector<std::wstring> errors;
+    };
+
+    /**
+     * What became of an input and each of its saves.
+     */
+    struct InputResult {
+        x360mse::batch::Input input;
+
+        /**
+         * The index of the input, in the order inputs were submitted.
+         */
+        size_t index = 0;
+
+        /**
+         * Whether the whole input could be read.
+         */
+        bool read = false;
+
+        /**
+         * Whether the input was cancelled before every save was converted.
+         */
+        bool cancelled = false;
+
+        /**
+         * The saves of the input, in the order they finished.
+         */
+        std::vector<SaveResult> saves;
+
+        /**
+         * What went wrong while reading the input, if anything.
+         */
+        std::vector<std::wstring> errors;
+
+        /**
+         * @param outcome the outcome to count.
+         * @return the number of saves with the outcome.
+         */
+        [[nodiscard]] size_t count(SaveOutcome outcome) const {
+            return static_cast<size_t>(std::ranges::count(saves, outcome, &SaveResult::outcome));
+        }
+
+        /**
+         * @return whether the input could not be read, or a save of it failed to convert.
+         */
+        [[nodiscard]] bool failed() const {
+            return (!read && !cancelled) || count(SaveOutcome::FAILED) > 0;
+        }
+    };
+
+    /**
+     * Handles the completion of an input; called from the thread finishing it,
+     * once the result of its submission is ready. Exceptions it throws are
+     * reported as errors of the input.
+     */
+    using ResultHandler = std::function<void(const InputResult&)>;
+
+    /**
+     * The settings shared by every input of a converter.
+     */
+    struct ConverterOptions {
+        /**
+         * The total number of threads shared by all conversions; zero for all cores.
+         */
+        unsigned int thread_total = 0;
+
+        /**
+         * The maximum number of saves converted, and of inputs read, at once; zero for a quarter of the threads.
+         */
+        unsigned int job_total = 0;
+
+        std::vector<x360mse::edition::Edition> editions { x360mse::edition::Edition::JAVA };
+
+        /**
+         * The format to pack converted worlds in; folders if none.
+         */
+        std::optional<x360mse::archive::OutputFormat> output_format;
+
+        x360mse::level::LevelOverrides overrides;
+        x360mse::selection::Selection selection;
+        x360mse::nesting::NestingLimits nesting;
+
+        /**
+         * Whether to also write the saves extracted from archives and images to the output folder.
+         */
+        bool keep_bin = false;
+
+        /**
+         * Whether to convert the saves found in folders where they are, rather than copying them.
+         */
+        bool in_place = false;
+
+        /**
+         * Whether to resume an interrupted run into the same output folder.
+         */
+        bool resume = false;
+
+        std::optional<std::filesystem::path> cache_directory;
+
+        /**
+         * The folder to write intermediate files to; the temporary folder if none.
+         */
+        std::optional<std::filesystem::path> scratch_directory;
+
+        /**
+         * The bytes intermediate files may take in memory; half of the RAM-backed file system if none.
+         */
+        std::optional<uintmax_t> scratch_memory;
+
+        /**
+         * The bytes running conversions may take in total; no limit if none.
+         */
+        std::optional<uint64_t> max_memory;
+
+        /**
+         * Whether to report the progress of extractions and conversions through job events.
+         */
+        bool report_progress = false;
+
+        /**
+         * The 7-zip library to read and write archives with.
+         */
+        std::filesystem::path library_path = L"7z.dll";
+    };
+
+    /**
+     * A handle to an input submitted to a converter.
+     */
+    class Submission {
+    public:
+        Submission(std::shared_future<InputResult> result, std::stop_source stop)
+                : result_(std::move(result)), stop_(std::move(stop)) {}
+
+        /**
+         * @return the result of the input, available once it was read and each of its saves converted.
+         */
+        [[nodiscard]] const std::shared_future<InputResult>& result() const {
+            return result_;
+        }
+
+        /**
+         * Cancels the input: saves not converted yet are dropped, and reading
+         * it stops at the next save. Running conversions are finished.
+         */
+        void cancel() {
+            stop_.request_stop();
+        }
+
+    private:
+        std::shared_future<InputResult> result_;
+        std::stop_source stop_;
+    };
+
+    /**
+     * Converts the saves of Minecraft Xbox 360 Edition inputs — archives,
+     * folders, disk images and save files — into worlds of later editions.
+     *
+     * Inputs are read on background threads as they are submitted, and
+     * their saves share a single conversion queue, cache, scratch space and
+     * memory budget; the 7-zip library and every thread stay up between
+     * inputs. Nothing is printed: what happens is reported through the
+     * events of each input, and its outcome through its result.
+     *
+     * Thread-safe.
+     */
+    class Converter {
+    public:
+        /**
+         * @param options the settings shared by every input.
+         * @throws std::exception if the 7-zip library cannot be loaded.
+         */
+        explicit Converter(ConverterOptions options);
+
+        Converter(const Converter&) = delete;
+        Converter& operator=(const Converter&) = delete;
+
+        /**
+         * Finishes every input submitted so far.
+         */
+        ~Converter();
+
+        /**
+         * Queues an input to convert.
+         *
+         * @param input the input, and the folder to convert its saves into.
+         * @param on_event the handler to report the events of the input to, if any.
+         * @param on_result the handler to hand the result of the input to once it is finished, if any.
+         * @return the handle to wait for or cancel the input through.
+         * @throws std::logic_error if the converter was closed.
+         */
+        Submission submit(x360mse::batch::Input input, x360mse::events::EventHandler on_event = {}, ResultHandler on_result = {});
+
+        /**
+         * Waits for every input submitted so far to finish; no input may be submitted afterwards.
+         */
+        void close();
+
+        /**
+         * @return the time and bytes spent in each stage, across every input.
+         */
+        [[nodiscard]] x360mse::metrics::MetricsReport& metrics();
+
+    private:
+        struct State;
+
+        std::unique_ptr<State> state_;
+    };
+
+    /**
+     * Lists the saves in an archive without extracting them.
+     *
+     * Only the headers of the archive are read, along with the
+     * '_MinecraftSaveInfo' files, which are extracted into memory to name
+     * each save after the world it holds. Nothing is written or converted.
+     *
+     * @param archive_path the path to the archive.
+     * @param library_path the 7-zip library to read the archive with.
+     * @return the saves in the archive, in archive order.
+     * @throws std::invalid_argument if the input is not an archive.
+     * @throws std::exception if the archive cannot be read.
+     */
+    std::vector<x360mse::inventory::SaveEntry> list_archive(const std::filesystem::path& archive_path, const std::filesystem::path& library_path = L"7z.dll");
+}
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef X360MSE_COPY_H
+#define X360MSE_COPY_H
+
+#include <cerrno>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+// If on Linux, files are cloned through the 'FICLONE' ioctl and copied in the
+// kernel through 'copy_file_range'; if on macOS, files are cloned through 'clonefile'.
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __APPLE__
+#include <sys/clonefile.h>
+#endif
+
+namespace x360mse::copy {
+    /**
+     * How a file was copied.
+     */
+    enum class CopyMethod {
+        REFLINK,
+        HARD_LINK,
+        COPY_FILE_RANGE,
+        COPY,
+    };
+
+    /**
+     * @param method the copy method.
+     * @return the verb describing the method in logs.
+     */
+    inline std::wstring to_wstring(CopyMethod method) {
+        switch (method) {
+            case CopyMethod::REFLINK: return L"Cloned";
+            case CopyMethod::HARD_LINK: return L"Linked";
+            default: return L"Copied";
+        }
+    }
+
+    namespace detail {
+#ifdef __linux__
+        /**
+         * Opens a pair of files to copy between; closes them when destroyed.
+         */
+        class FilePair {
+        public:
+            FilePair(const std::filesystem::path& from, const std::filesystem::path& to) {
+                in_ = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+
+                if (in_ >= 0) {
+                    out_ = open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+                }
+            }
+
+            FilePair(const FilePair&) = delete;
+            FilePair& operator=(const FilePair&) = delete;
+
+            ~FilePair() {
+                if (in_ >= 0) {
+                    close(in_);
+                }
+
+                if (out_ >= 0) {
+                    close(out_);
+                }
+            }
+
+            [[nodiscard]] bool opened() const {
+                return in_ >= 0 && out_ >= 0;
+            }
+
+            [[nodiscard]] int in() const {
+                return in_;
+            }
+
+            [[nodiscard]] int out() const {
+                return out_;
+            }
+
+        private:
+            int in_ = -1;
+            int out_ = -1;
+        };
+
+        /**
+         * @return whether the error means the file system cannot do this kind of copy, rather than that the copy failed.
+         */
+        inline bool is_unsupported(int error) {
+            return error == EXDEV || error == ENOSYS || error == EINVAL || error == EOPNOTSUPP || error == ENOTTY || error == EPERM;
+        }
+
+        inline bool clone(const std::filesystem::path& from, const std::filesystem::path& to) {
+#ifdef FICLONE
+            bool cloned = false;
+
+            {
+                const FilePair files { from, to };
+
+                if (!files.opened()) {
+                    return false;
+                }
+
+                cloned = ioctl(files.out(), FICLONE, files.in()) == 0;
+            }
+
+            if (!cloned) {
+                unlink(to.c_str());
+            }
+
+            return cloned;
+#else
+            return false;
+#endif
+        }
+
+        inline bool copy_range(const std::filesystem::path& from, const std::filesystem::path& to) {
+            std::error_code size_error;
+            auto remaining = std::filesystem::file_size(from, size_error);
+
+            if (size_error) {
+                return false;
+            }
+
+            int copy_error = 0;
+            bool first = true;
+
+            {
+                const FilePair files { from, to };
+
+                if (!files.opened()) {
+                    return false;
+                }
+
+                while (remaining > 0) {
+                    const auto copied = copy_file_range(files.in(), nullptr, files.out(), nullptr, remaining, 0);
+
+                    if (copied < 0) {
+                        copy_error = errno;
+                        break;
+                    }
+
+                    // Nothing was copied before the end of the file: either the file system
+                    // reports files it cannot copy in the kernel as empty, or the file was
+                    // truncated while it was being copied. Never keep a short copy.
+                    if (copied == 0) {
+                        copy_error = first ? EOPNOTSUPP : EIO;
+                        break;
+                    }
+
+                    remaining -= static_cast<uintmax_t>(copied);
+                    first = false;
+                }
+            }
+
+            if (copy_error == 0) {
+                return true;
+            }
+
+            unlink(to.c_str());
+
+            if (first && is_unsupported(copy_error)) {
+                return false;
+            }
+
+            throw std::filesystem::filesystem_error("Failed to copy file", from, to, std::error_code(copy_error, std::generic_category()));
+        }
+#endif
+    }
+
+    /**
+     * Copies a file through the cheapest means the file system supports.
+     *
+     * The file is cloned where the file system supports reflinks, so no data
+     * is written until either file changes; hard linked where both files are
+     * on the same volume; copied within the kernel on Linux otherwise; and
+     * copied through user space as a last resort.
+     *
+     * Hard links share their data with the original, so writing to either
+     * file changes both; they should only be allowed when neither is written
+     * to in place afterward.
+     *
+     * @param from the file to copy.
+     * @param to the path to copy it to; must not exist.
+     * @param allow_hard_link whether the file may be hard linked.
+     * @return how the file was copied.
+     * @throws std::filesystem::filesystem_error if the file could not be copied.
+     */
+    inline CopyMethod copy_file(const std::filesystem::path& from, const std::filesystem::path& to, bool allow_hard_link = true) {
+#ifdef __APPLE__
+        if (clonefile(from.c_str(), to.c_str(), 0) == 0) {
+            return CopyMethod::REFLINK;
+        }
+#endif
+
+#ifdef __linux__
+        if (detail::clone(from, to)) {
+            return CopyMethod::REFLINK;
+        }
+#endif
+
+        if (allow_hard_link) {
+            std::error_code error;
+            std::filesystem::create_hard_link(from, to, error);
+
+            if (!error) {
+                return CopyMethod::HARD_LINK;
+            }
+        }
+
+#ifdef __linux__
+        if (detail::copy_range(from, to)) {
+            return CopyMethod::COPY_FILE_RANGE;
+        }
+#endif
+
+        std::filesystem::copy_file(from, to);
+
+        return CopyMethod::COPY;
+    }
+}
+
+#endif
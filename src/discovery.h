@@ -0,0 +1,219 @@
+#ifndef X360MSE_DISCOVERY_H
+#define X360MSE_DISCOVERY_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <thread>
+#include <vector>
+
+namespace x360mse::discovery {
+    /**
+     * A folder holding save files, along with the '_MinecraftSaveInfo'
+     * file describing them, if there is one.
+     */
+    struct SaveDirectory {
+        std::filesystem::path directory;
+        std::vector<std::filesystem::path> save_files;
+        std::optional<std::filesystem::path> save_info_file;
+    };
+
+    /**
+     * The result of a discovery.
+     */
+    struct DiscoveryResult {
+        std::vector<SaveDirectory> directories;
+        size_t directories_scanned = 0;
+        std::chrono::nanoseconds duration { 0 };
+    };
+
+    /**
+     * Recursively finds every folder holding save files under the specified root.
+     *
+     * Subtrees are walked in parallel; each worker keeps its own queue of
+     * folders to scan and steals from the others once it runs out, so deep
+     * and shallow subtrees are balanced across workers.
+     *
+     * Folders that cannot be read and entries whose names cannot be matched
+     * are skipped, and symbolic links to folders are not followed. Workers
+     * without a folder to scan sleep until one is found.
+     *
+     * @param root the folder to start from.
+     * @param minecraft_save_info_pattern the pattern to match save info files.
+     * @param save_file_pattern the pattern to match save files.
+     * @param thread_count the number of workers to walk the tree with.
+     * @return the folders holding save files, sorted by path.
+     */
+    inline DiscoveryResult discover(
+            const std::filesystem::path& root,
+            const std::wregex& minecraft_save_info_pattern,
+            const std::wregex& save_file_pattern,
+            unsigned int thread_count
+            ) {
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<std::filesystem::path> directories;
+        };
+
+        const auto then = std::chrono::steady_clock::now();
+
+        const auto worker_total = std::max(1u, thread_count);
+
+        std::vector<WorkQueue> queues(worker_total);
+        std::atomic<size_t> pending = 1;
+        std::atomic<size_t> queued = 1;
+        std::atomic<size_t> scanned = 0;
+
+        // Workers out of folders to scan wait here rather than polling the queues.
+        std::mutex idle_mutex;
+        std::condition_variable idle_condition;
+        std::atomic<size_t> idle = 0;
+
+        const auto wake = [&](bool all) {
+            // Take the lock so a worker about to wait cannot miss the change.
+            if (idle > 0 || all) {
+                {
+                    std::lock_guard lock(idle_mutex);
+                }
+
+                all ? idle_condition.notify_all() : idle_condition.notify_one();
+            }
+        };
+
+        std::mutex result_mutex;
+        DiscoveryResult result;
+
+        queues[0].directories.push_back(root);
+
+        auto scan = [&](size_t worker_index, const std::filesystem::path& directory) {
+            SaveDirectory save_directory;
+            save_directory.directory = directory;
+
+            std::error_code error;
+            auto iterator = std::filesystem::directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, error);
+
+            for (const auto end = std::filesystem::directory_iterator(); !error && iterator != end; iterator.increment(error)) {
+                const auto& entry = *iterator;
+
+                std::error_code status_error;
+
+                try {
+                    if (entry.is_directory(status_error) && !entry.is_symlink(status_error)) {
+                        {
+                            // Count the folder before releasing the lock, so no other worker can take it uncounted.
+                            std::lock_guard lock(queues[worker_index].mutex);
+                            queues[worker_index].directories.push_back(entry.path());
+
+                            pending += 1;
+                            queued += 1;
+                        }
+
+                        wake(false);
+                    } else if (entry.is_regular_file(status_error)) {
+                        const auto file_name = entry.path().filename().wstring();
+
+                        if (std::regex_match(file_name, save_file_pattern)) {
+                            save_directory.save_files.push_back(entry.path());
+                        } else if (std::regex_match(file_name, minecraft_save_info_pattern)) {
+                            save_directory.save_info_file = entry.path();
+                        }
+                    }
+                } catch (const std::exception&) {
+                    // The name cannot be converted or matched, e.g. as it is not valid
+                    // in the current locale; skip the entry rather than the walk.
+                }
+            }
+
+            scanned += 1;
+
+            if (!save_directory.save_files.empty()) {
+                std::ranges::sort(save_directory.save_files);
+
+                std::lock_guard lock(result_mutex);
+                result.directories.push_back(std::move(save_directory));
+            }
+        };
+
+        auto next = [&](size_t worker_index) -> std::optional<std::filesystem::path> {
+            // Take the most recently found folder from our own queue, to walk depth-first.
+            {
+                auto& queue = queues[worker_index];
+
+                std::lock_guard lock(queue.mutex);
+
+                if (!queue.directories.empty()) {
+                    auto directory = std::move(queue.directories.back());
+                    queue.directories.pop_back();
+                    queued -= 1;
+
+                    return directory;
+                }
+            }
+
+            // Otherwise, steal the oldest folder from another queue, as it is the
+            // most likely to hold a large subtree.
+            for (size_t offset = 1; offset < worker_total; offset += 1) {
+                auto& queue = queues[(worker_index + offset) % worker_total];
+
+                std::lock_guard lock(queue.mutex);
+
+                if (!queue.directories.empty()) {
+                    auto directory = std::move(queue.directories.front());
+                    queue.directories.pop_front();
+                    queued -= 1;
+
+                    return directory;
+                }
+            }
+
+            return std::nullopt;
+        };
+
+        auto work = [&](size_t worker_index) {
+            while (pending > 0) {
+                if (auto directory = next(worker_index)) {
+                    try {
+                        scan(worker_index, *directory);
+                    } catch (const std::exception&) {
+                        // Skip the folder; it must still be counted as done, or the walk never ends.
+                    }
+
+                    if (--pending == 0) {
+                        wake(true);
+                    }
+                } else {
+                    std::unique_lock lock(idle_mutex);
+
+                    idle += 1;
+                    idle_condition.wait(lock, [&]() { return queued > 0 || pending == 0; });
+                    idle -= 1;
+                }
+            }
+        };
+
+        std::vector<std::jthread> workers;
+
+        for (size_t worker_index = 1; worker_index < worker_total; worker_index += 1) {
+            workers.emplace_back(work, worker_index);
+        }
+
+        work(0);
+
+        workers.clear();
+
+        std::ranges::sort(result.directories, {}, &SaveDirectory::directory);
+
+        result.directories_scanned = scanned;
+        result.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - then);
+
+        return result;
+    }
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef X360MSE_EDITION_H
+#define X360MSE_EDITION_H
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <je2be.hpp>
+
+namespace x360mse::edition {
+    /**
+     * An edition of Minecraft saves are converted to.
+     */
+    enum class Edition {
+        JAVA,
+        BEDROCK,
+    };
+
+    /**
+     * @param edition the edition to name.
+     * @return the name of the edition, as given to '--target'.
+     */
+    inline const char* to_string(Edition edition) {
+        switch (edition) {
+            case Edition::JAVA: return "java";
+            case Edition::BEDROCK: return "bedrock";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * Parses a comma-separated list of editions.
+     *
+     * @param names the names of the editions, e.g. 'java,bedrock'.
+     * @return the editions, Java Edition first if requested, without duplicates.
+     * @throws std::invalid_argument if a name is not a known edition, or none is given.
+     */
+    inline std::vector<Edition> parse_editions(const std::string& names) {
+        std::vector<Edition> editions;
+        size_t start = 0;
+
+        while (start <= names.size()) {
+            const auto end = std::min(names.find(',', start), names.size());
+            const auto name = names.substr(start, end - start);
+
+            if (name == "java") {
+                editions.push_back(Edition::JAVA);
+            } else if (name == "bedrock") {
+                editions.push_back(Edition::BEDROCK);
+            } else if (!name.empty()) {
+                throw std::invalid_argument("Unknown target edition: " + name);
+            }
+
+            start = end + 1;
+        }
+
+        if (editions.empty()) {
+            throw std::invalid_argument("No target edition given");
+        }
+
+        std::ranges::sort(editions);
+        editions.erase(std::unique(editions.begin(), editions.end()), editions.end());
+
+        return editions;
+    }
+
+    /**
+     * A world to write for a save.
+     */
+    struct Output {
+        Edition edition;
+
+        /**
+         * The folder, or the archive, to write the world to.
+         */
+        std::filesystem::path path;
+    };
+
+    /**
+     * Names the output of an edition after the output of the first requested edition.
+     *
+     * The first edition keeps the plain name of the save; the others are told
+     * apart by a suffix, e.g. 'Save (Bedrock)'.
+     *
+     * @param primary_path the output of the first requested edition.
+     * @param edition the edition to name the output of.
+     * @param primary the first requested edition.
+     * @return the output of the edition.
+     */
+    inline std::filesystem::path output_path(const std::filesystem::path& primary_path, Edition edition, Edition primary) {
+        if (edition == primary) {
+            return primary_path;
+        }
+
+        auto name = primary_path.stem().wstring();
+        name += edition == Edition::BEDROCK ? L" (Bedrock)" : L" (Java)";
+        name += primary_path.extension().wstring();
+
+        return primary_path.parent_path() / name;
+    }
+
+    /**
+     * Converts a Java Edition world to a Bedrock Edition world.
+     *
+     * @param java_world the folder of the Java Edition world.
+     * @param bedrock_world the folder to write the Bedrock Edition world to.
+     * @param temp_directory the folder to write intermediate files to.
+     * @param thread_count the number of threads the converter may use.
+     * @return the status of the conversion.
+     */
+    inline je2be::Status convert_to_bedrock(
+            const std::filesystem::path& java_world,
+            const std::filesystem::path& bedrock_world,
+            const std::filesystem::path& temp_directory,
+            unsigned int thread_count
+            ) {
+        je2be::java::Options options;
+        options.fTempDirectory = temp_directory;
+
+        std::filesystem::create_directories(temp_directory);
+        std::filesystem::create_directories(bedrock_world);
+
+        return je2be::java::Converter::Run(java_world, bedrock_world, options, thread_count, nullptr);
+    }
+}
+
+#endif
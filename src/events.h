@@ -0,0 +1,275 @@
+#ifndef X360MSE_EVENTS_H
+#define X360MSE_EVENTS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace x360mse::events {
+    /**
+     * What happened to an input or to one of its saves.
+     */
+    enum class EventType {
+        // The input started being read.
+        INPUT_STARTED,
+        // An interrupted run into the output folder of the input was resumed, or could not be.
+        RUN_RESUMED,
+        // The kind of the input, or of an archive nested in it, was recognized.
+        INPUT_DETECTED,
+        // A '_MinecraftSaveInfo' file was parsed; its save bins are listed in the details.
+        SAVE_INFO_FOUND,
+        // The save files of a folder or a disk image were found.
+        SAVES_DISCOVERED,
+        // A save was extracted, copied or read, and handed to the converter.
+        SAVE_READ,
+        // A save was not read again, as an earlier run finished or kept it.
+        SAVE_SKIPPED,
+        // A save started being converted.
+        CONVERSION_STARTED,
+        // Every world of a save was written, or reused.
+        SAVE_CONVERTED,
+        // A save failed to convert.
+        SAVE_FAILED,
+        // Something went wrong; the message tells what.
+        ERROR_OCCURRED,
+        // The input was read, and each of its saves converted or failed.
+        INPUT_FINISHED,
+        // A long-running job started; its label is the message.
+        JOB_STARTED,
+        // A job reports the fraction of it completed.
+        JOB_PROGRESS,
+        // A job ended.
+        JOB_ENDED,
+    };
+
+    /**
+     * The place of an item among the items it is counted with, e.g. '[2 / 5]'.
+     */
+    struct Position {
+        size_t index;
+
+        /**
+         * The number of items, unless still unknown, e.g. while inputs are being submitted.
+         */
+        std::optional<size_t> total;
+    };
+
+    /**
+     * An event reported while an input is converted.
+     */
+    struct Event {
+        EventType type;
+
+        /**
+         * The index of the input the event is about, in the order inputs were submitted.
+         */
+        size_t input_index = 0;
+
+        std::optional<Position> position;
+
+        /**
+         * What happened, as a sentence.
+         */
+        std::wstring message;
+
+        /**
+         * Lines further describing the event, e.g. the save bins of a '_MinecraftSaveInfo' file.
+         */
+        std::vector<std::wstring> details;
+
+        std::optional<std::chrono::milliseconds> duration;
+
+        /**
+         * The peak memory taken by a conversion, in bytes.
+         */
+        std::optional<uint64_t> memory;
+
+        /**
+         * The job the event is about, for job events.
+         */
+        uint64_t job = 0;
+
+        /**
+         * The completed fraction of the job, between 0 and 1, for progress events.
+         */
+        double fraction = 0.0;
+
+        /**
+         * The completed fraction of the job, updated in place on every tick, for job start events.
+         *
+         * Progress events are only reported once the fraction moved noticeably;
+         * handlers drawing progress read this instead, at their own pace.
+         */
+        std::shared_ptr<const std::atomic<double>> progress;
+    };
+
+    /**
+     * Receives the events of an input; called from the threads reading and converting it.
+     */
+    using EventHandler = std::function<void(const Event&)>;
+
+    namespace detail {
+        inline std::atomic<uint64_t> next_job = 1;
+    }
+
+    /**
+     * Reports the events of an input to its handler, if any.
+     */
+    class Reporter {
+    public:
+        /**
+         * A handle to report the progress of a job through; the job is ended when the handle is destroyed.
+         *
+         * Reporting progress is a single atomic store; a progress event is
+         * only reported every half a percent, as reporting one on every tick
+         * slows down the job.
+         */
+        class Job {
+        public:
+            Job() = default;
+
+            Job(const Reporter* reporter, uint64_t id, std::shared_ptr<std::atomic<double>> progress)
+                    : reporter_(reporter), id_(id), progress_(std::move(progress)) {}
+
+            Job(const Job&) = delete;
+            Job& operator=(const Job&) = delete;
+
+            Job(Job&& other) noexcept
+                    : reporter_(std::exchange(other.reporter_, nullptr)),
+                      id_(other.id_),
+                      progress_(std::move(other.progress_)),
+                      reported_fraction_(other.reported_fraction_) {}
+
+            Job& operator=(Job&& other) noexcept {
+                if (this != &other) {
+                    end();
+
+                    reporter_ = std::exchange(other.reporter_, nullptr);
+                    id_ = other.id_;
+                    progress_ = std::move(other.progress_);
+                    reported_fraction_ = other.reported_fraction_;
+                }
+
+                return *this;
+            }
+
+            ~Job() {
+                end();
+            }
+
+            /**
+             * Reports the completed fraction of the job; called from one thread at a time.
+             *
+             * @param fraction the completed fraction, between 0 and 1.
+             */
+            void update(double fraction) const {
+                if (!reporter_) {
+                    return;
+                }
+
+                fraction = std::clamp(fraction, 0.0, 1.0);
+                progress_->store(fraction, std::memory_order_relaxed);
+
+                // Completion is always reported, even if close to the last fraction reported.
+                const auto completed = fraction == 1.0 && reported_fraction_ < 1.0;
+
+                if (std::abs(fraction - reported_fraction_) < 0.005 && !completed) {
+                    return;
+                }
+
+                reported_fraction_ = fraction;
+                reporter_->emit({ .type = EventType::JOB_PROGRESS, .job = id_, .fraction = fraction });
+            }
+
+            /**
+             * Ends the job.
+             */
+            void end() {
+                if (const auto* reporter = std::exchange(reporter_, nullptr)) {
+                    reporter->emit({ .type = EventType::JOB_ENDED, .job = id_ });
+                }
+            }
+
+        private:
+            const Reporter* reporter_ = nullptr;
+            uint64_t id_ = 0;
+            std::shared_ptr<std::atomic<double>> progress_;
+
+            // The fraction last reported in a progress event.
+            mutable double reported_fraction_ = 0.0;
+        };
+
+        Reporter() = default;
+
+        /**
+         * @param handler the handler to report events to; events are dropped if empty.
+         * @param input_index the index of the input the events are about.
+         * @param progress_enabled whether to report the progress of jobs.
+         */
+        Reporter(EventHandler handler, size_t input_index, bool progress_enabled)
+                : handler_(std::move(handler)), input_index_(input_index), progress_enabled_(progress_enabled && handler_) {}
+
+        /**
+         * @return whether the progress of jobs is reported; when it is not, jobs cost nothing to report.
+         */
+        [[nodiscard]] bool progress_enabled() const {
+            return progress_enabled_;
+        }
+
+        /**
+         * Reports an event.
+         *
+         * @param event the event; its input index is set by the reporter.
+         */
+        void emit(Event event) const {
+            if (handler_) {
+                event.input_index = input_index_;
+                handler_(event);
+            }
+        }
+
+        /**
+         * Reports an error.
+         *
+         * @param message what went wrong.
+         */
+        void error(std::wstring message) const {
+            emit({ .type = EventType::ERROR_OCCURRED, .message = std::move(message) });
+        }
+
+        /**
+         * Starts a job, reported until the returned handle is destroyed.
+         *
+         * @param label the text describing the job.
+         * @return the handle to report the progress of the job through.
+         */
+        [[nodiscard]] Job begin_job(std::wstring label) const {
+            if (!progress_enabled_) {
+                return {};
+            }
+
+            const auto id = detail::next_job++;
+            auto progress = std::make_shared<std::atomic<double>>(-1.0);
+
+            emit({ .type = EventType::JOB_STARTED, .message = std::move(label), .job = id, .progress = progress });
+
+            return { this, id, std::move(progress) };
+        }
+
+    private:
+        EventHandler handler_;
+        size_t input_index_ = 0;
+        bool progress_enabled_ = false;
+    };
+}
+
+#endif
@@ -0,0 +1,522 @@
+#ifndef X360MSE_FATX_H
+#define X360MSE_FATX_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// If on Windows, images are mapped through file mappings; elsewhere, through 'mmap'.
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace x360mse::fatx {
+    /**
+     * A file mapped read-only into memory.
+     */
+    class MappedFile {
+    public:
+        /**
+         * Maps a file into memory.
+         *
+         * @param path the file to map.
+         * @throws std::runtime_error if the file could not be mapped.
+         */
+        explicit MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+            file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+            if (file_ == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Failed to open " + path.string());
+            }
+
+            LARGE_INTEGER size;
+
+            if (!GetFileSizeEx(file_, &size)) {
+                CloseHandle(file_);
+                throw std::runtime_error("Failed to read the size of " + path.string());
+            }
+
+            size_ = static_cast<size_t>(size.QuadPart);
+
+            if (size_ == 0) {
+                return;
+            }
+
+            mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            if (!mapping_) {
+                CloseHandle(file_);
+                throw std::runtime_error("Failed to map " + path.string());
+            }
+
+            data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+
+            if (!data_) {
+                CloseHandle(mapping_);
+                CloseHandle(file_);
+                throw std::runtime_error("Failed to map " + path.string());
+            }
+#else
+            descriptor_ = open(path.c_str(), O_RDONLY);
+
+            if (descriptor_ < 0) {
+                throw std::runtime_error("Failed to open " + path.string());
+            }
+
+            struct stat info {};
+
+            if (fstat(descriptor_, &info) != 0) {
+                close(descriptor_);
+                throw std::runtime_error("Failed to read the size of " + path.string());
+            }
+
+            size_ = static_cast<size_t>(info.st_size);
+
+            if (size_ == 0) {
+                return;
+            }
+
+            auto* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, descriptor_, 0);
+
+            if (data == MAP_FAILED) {
+                close(descriptor_);
+                throw std::runtime_error("Failed to map " + path.string());
+            }
+
+            data_ = static_cast<const uint8_t*>(data);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (data_) {
+                UnmapViewOfFile(data_);
+            }
+
+            if (mapping_) {
+                CloseHandle(mapping_);
+            }
+
+            CloseHandle(file_);
+#else
+            if (data_) {
+                munmap(const_cast<uint8_t*>(data_), size_);
+            }
+
+            close(descriptor_);
+#endif
+        }
+
+        /**
+         * @return the contents of the file.
+         */
+        [[nodiscard]] std::span<const uint8_t> bytes() const {
+            return { data_, size_ };
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+#else
+        int descriptor_ = -1;
+#endif
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    /**
+     * The magic number at the start of every Xbox 360 FATX partition.
+     */
+    constexpr std::array<uint8_t, 4> MAGIC = { 'X', 'T', 'A', 'F' };
+
+    /**
+     * The size of the header at the start of a partition, before its allocation table.
+     */
+    constexpr uint64_t HEADER_SIZE = 0x1000;
+
+    /**
+     * The size of a directory entry.
+     */
+    constexpr uint64_t ENTRY_SIZE = 0x40;
+
+    /**
+     * The longest file name a directory entry can hold.
+     */
+    constexpr uint8_t MAX_NAME_LENGTH = 42;
+
+    /**
+     * The partitions of a retail Xbox 360 hard drive, as offset and size; a
+     * size of 0 spans to the end of the drive. Saves live in the last one.
+     */
+    constexpr std::array<std::pair<uint64_t, uint64_t>, 5> HDD_PARTITIONS = { {
+        { 0x80000, 0x80000000 },
+        { 0x80080000, 0xA0E30000 },
+        { 0x10C080000, 0xCE30000 },
+        { 0x118EB0000, 0x8000000 },
+        { 0x130EB0000, 0 },
+    } };
+
+    namespace detail {
+        inline uint32_t read_u32(const uint8_t* data) {
+            return (uint32_t { data[0] } << 24) | (uint32_t { data[1] } << 16) | (uint32_t { data[2] } << 8) | uint32_t { data[3] };
+        }
+
+        inline uint16_t read_u16(const uint8_t* data) {
+            return static_cast<uint16_t>((data[0] << 8) | data[1]);
+        }
+    }
+
+    /**
+     * A FATX partition of an image.
+     */
+    struct Partition {
+        uint64_t offset;
+        uint64_t size;
+        uint64_t cluster_size;
+        uint32_t cluster_count;
+        uint32_t root_cluster;
+
+        // Allocation table entries are 16 bits wide on small partitions, and 32 bits wide otherwise.
+        uint32_t table_entry_size;
+        uint64_t data_offset;
+    };
+
+    /**
+     * A file found in a FATX partition.
+     */
+    struct File {
+        size_t partition;
+        // The path of the file from the root of its partition, separated by '/'.
+        std::string path;
+        uint32_t first_cluster;
+        uint32_t size;
+    };
+
+    /**
+     * An Xbox 360 disk image, mapped into memory and read in place.
+     *
+     * The image may hold a whole hard drive, in which case the partitions are
+     * found at their fixed offsets, or a single partition. Directory tables and
+     * allocation tables are read straight from the mapping; the contents of
+     * files are handed out as views into it when they are stored contiguously,
+     * which is the common case.
+     */
+    class FatxImage {
+    public:
+        /**
+         * Maps a disk image and finds its partitions.
+         *
+         * @param path the disk image.
+         * @return the image.
+         * @throws std::runtime_error if the image could not be mapped or holds no FATX partition.
+         */
+        static std::shared_ptr<FatxImage> open(const std::filesystem::path& path) {
+            auto image = std::shared_ptr<FatxImage>(new FatxImage(path));
+
+            if (image->partitions_.empty()) {
+                throw std::runtime_error("No FATX partition found in " + path.string());
+            }
+
+            return image;
+        }
+
+        /**
+         * Checks whether a file is an Xbox 360 disk image, without mapping it.
+         *
+         * @param path the file to check.
+         * @return whether a FATX partition starts at the start of the file or at a hard drive partition offset.
+         */
+        static bool is_image(const std::filesystem::path& path) {
+            auto stream = std::ifstream { path, std::ios::binary };
+
+            if (!stream) {
+                return false;
+            }
+
+            auto has_magic = [&](uint64_t offset) {
+                std::array<uint8_t, 4> magic {};
+
+                stream.clear();
+                stream.seekg(static_cast<std::streamoff>(offset));
+                stream.read(reinterpret_cast<char*>(magic.data()), static_cast<std::streamsize>(magic.size()));
+
+                return stream.gcount() == static_cast<std::streamsize>(magic.size()) && magic == MAGIC;
+            };
+
+            if (has_magic(0)) {
+                return true;
+            }
+
+            for (const auto& [offset, size] : HDD_PARTITIONS) {
+                if (has_magic(offset)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * @return the partitions of the image.
+         */
+        [[nodiscard]] const std::vector<Partition>& partitions() const {
+            return partitions_;
+        }
+
+        /**
+         * Walks every directory of every partition.
+         *
+         * @param include the function deciding whether to list a file, given its name.
+         * @return the files listed.
+         */
+        [[nodiscard]] std::vector<File> list_files(const std::function<bool(const std::string&)>& include) const {
+            std::vector<File> files;
+
+            for (size_t partition_index = 0; partition_index < partitions_.size(); partition_index += 1) {
+                const auto& partition = partitions_[partition_index];
+
+                std::vector<std::pair<uint32_t, std::string>> pending = { { partition.root_cluster, "" } };
+                std::unordered_set<uint32_t> visited;
+
+                while (!pending.empty()) {
+                    const auto [directory_cluster, directory_path] = std::move(pending.back());
+                    pending.pop_back();
+
+                    // A corrupted table may link directories into a cycle.
+                    if (!visited.insert(directory_cluster).second) {
+                        continue;
+                    }
+
+                    for_each_entry(partition, directory_cluster, [&](const uint8_t* entry) {
+                        const auto name = std::string(reinterpret_cast<const char*>(entry + 2), entry[0]);
+                        const auto attributes = entry[1];
+                        const auto first_cluster = detail::read_u32(entry + 0x2C);
+                        const auto size = detail::read_u32(entry + 0x30);
+
+                        const auto path = directory_path.empty() ? name : directory_path + "/" + name;
+
+                        if (attributes & 0x10) {
+                            pending.emplace_back(first_cluster, path);
+                        } else if (include(name)) {
+                            files.push_back(File { partition_index, path, first_cluster, size });
+                        }
+                    });
+                }
+            }
+
+            return files;
+        }
+
+        /**
+         * Views the contents of a file in place, if they are stored contiguously.
+         *
+         * @param file the file to view.
+         * @return the contents of the file, or nothing if they are fragmented.
+         */
+        [[nodiscard]] std::optional<std::span<const uint8_t>> view(const File& file) const {
+            if (file.size == 0) {
+                return std::span<const uint8_t> {};
+            }
+
+            const auto& partition = partitions_[file.partition];
+            const auto cluster_total = (file.size + partition.cluster_size - 1) / partition.cluster_size;
+
+            auto cluster = file.first_cluster;
+
+            for (uint64_t cluster_index = 1; cluster_index < cluster_total; cluster_index += 1) {
+                const auto next = next_cluster(partition, cluster);
+
+                if (!next || *next != cluster + 1) {
+                    return std::nullopt;
+                }
+
+                cluster = *next;
+            }
+
+            const auto offset = cluster_offset(partition, file.first_cluster);
+
+            if (!offset || *offset + file.size > image_->bytes().size()) {
+                throw std::runtime_error("File extends past the end of the image: " + file.path);
+            }
+
+            return image_->bytes().subspan(*offset, file.size);
+        }
+
+        /**
+         * Reads the contents of a file by following its cluster chain.
+         *
+         * @param file the file to read.
+         * @return the contents of the file.
+         * @throws std::runtime_error if the chain leaves the image, loops, or ends before the size of the file.
+         */
+        [[nodiscard]] std::vector<uint8_t> read(const File& file) const {
+            const auto& partition = partitions_[file.partition];
+
+            std::vector<uint8_t> data;
+            data.reserve(file.size);
+
+            std::unordered_set<uint32_t> visited;
+
+            for (auto cluster = std::optional<uint32_t> { file.first_cluster }; cluster && data.size() < file.size; cluster = next_cluster(partition, *cluster)) {
+                // A corrupted table may link the clusters of a file into a cycle, which would repeat its contents.
+                if (!visited.insert(*cluster).second) {
+                    throw std::runtime_error("Cluster chain of file loops: " + file.path);
+                }
+
+                const auto offset = cluster_offset(partition, *cluster);
+                const auto count = std::min<uint64_t>(partition.cluster_size, file.size - data.size());
+
+                if (!offset || *offset + count > image_->bytes().size()) {
+                    throw std::runtime_error("File extends past the end of the image: " + file.path);
+                }
+
+                const auto bytes = image_->bytes().subspan(*offset, count);
+                data.insert(data.end(), bytes.begin(), bytes.end());
+            }
+
+            if (data.size() != file.size) {
+                throw std::runtime_error("File is shorter than its directory entry claims: " + file.path);
+            }
+
+            return data;
+        }
+
+    private:
+        explicit FatxImage(const std::filesystem::path& path)
+                : image_(std::make_unique<MappedFile>(path)) {
+            const auto image_size = image_->bytes().size();
+
+            if (has_magic(0)) {
+                add_partition(0, image_size);
+                return;
+            }
+
+            for (const auto& [offset, size] : HDD_PARTITIONS) {
+                if (offset < image_size && has_magic(offset)) {
+                    add_partition(offset, size == 0 || offset + size > image_size ? image_size - offset : size);
+                }
+            }
+        }
+
+        bool has_magic(uint64_t offset) const {
+            const auto bytes = image_->bytes();
+
+            return offset + MAGIC.size() <= bytes.size() && std::memcmp(bytes.data() + offset, MAGIC.data(), MAGIC.size()) == 0;
+        }
+
+        void add_partition(uint64_t offset, uint64_t size) {
+            const auto* header = image_->bytes().data() + offset;
+
+            if (size < HEADER_SIZE) {
+                return;
+            }
+
+            Partition partition {};
+            partition.offset = offset;
+            partition.size = size;
+            partition.cluster_size = uint64_t { detail::read_u32(header + 0x08) } * 512;
+            partition.root_cluster = detail::read_u32(header + 0x0C);
+
+            if (partition.cluster_size == 0 || partition.cluster_size % ENTRY_SIZE != 0) {
+                return;
+            }
+
+            // The allocation table has an entry for every cluster the partition
+            // could hold, and is padded to a multiple of the page size.
+            partition.cluster_count = static_cast<uint32_t>(size / partition.cluster_size);
+            partition.table_entry_size = partition.cluster_count < 0xFFF0 ? 2 : 4;
+
+            const auto table_size = (uint64_t { partition.cluster_count } * partition.table_entry_size + 0xFFF) & ~uint64_t { 0xFFF };
+
+            partition.data_offset = offset + HEADER_SIZE + table_size;
+
+            partitions_.push_back(partition);
+        }
+
+        std::optional<uint64_t> cluster_offset(const Partition& partition, uint32_t cluster) const {
+            // Cluster numbers start at 1.
+            if (cluster == 0 || cluster > partition.cluster_count) {
+                return std::nullopt;
+            }
+
+            return partition.data_offset + (uint64_t { cluster } - 1) * partition.cluster_size;
+        }
+
+        std::optional<uint32_t> next_cluster(const Partition& partition, uint32_t cluster) const {
+            const auto entry_offset = partition.offset + HEADER_SIZE + uint64_t { cluster } * partition.table_entry_size;
+
+            if (cluster > partition.cluster_count || entry_offset + partition.table_entry_size > image_->bytes().size()) {
+                return std::nullopt;
+            }
+
+            const auto* entry = image_->bytes().data() + entry_offset;
+
+            const auto next = partition.table_entry_size == 2 ?
+                    (detail::read_u16(entry) >= 0xFFF0 ? 0 : uint32_t { detail::read_u16(entry) }) :
+                    (detail::read_u32(entry) >= 0xFFFFFFF0 ? 0 : detail::read_u32(entry));
+
+            if (next == 0 || next > partition.cluster_count) {
+                return std::nullopt;
+            }
+
+            return next;
+        }
+
+        void for_each_entry(const Partition& partition, uint32_t first_cluster, const std::function<void(const uint8_t*)>& function) const {
+            // A corrupted table may link the clusters of a directory into a cycle; read each once.
+            std::unordered_set<uint32_t> visited;
+
+            for (auto cluster = std::optional<uint32_t> { first_cluster }; cluster && visited.insert(*cluster).second; cluster = next_cluster(partition, *cluster)) {
+                const auto offset = cluster_offset(partition, *cluster);
+
+                if (!offset || *offset + partition.cluster_size > image_->bytes().size()) {
+                    return;
+                }
+
+                for (uint64_t entry_offset = 0; entry_offset < partition.cluster_size; entry_offset += ENTRY_SIZE) {
+                    const auto* entry = image_->bytes().data() + *offset + entry_offset;
+                    const auto name_length = entry[0];
+
+                    // The end of the directory.
+                    if (name_length == 0x00 || name_length == 0xFF) {
+                        return;
+                    }
+
+                    // A deleted entry, or a corrupted one.
+                    if (name_length == 0xE5 || name_length > MAX_NAME_LENGTH) {
+                        continue;
+                    }
+
+                    function(entry);
+                }
+            }
+        }
+
+        std::unique_ptr<MappedFile> image_;
+        std::vector<Partition> partitions_;
+    };
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef X360MSE_FORMAT_H
+#define X360MSE_FORMAT_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bit7z/bitformat.hpp"
+
+namespace x360mse::format {
+    /**
+     * The format of an input file, as identified by its contents.
+     */
+    enum class InputFormat {
+        UNKNOWN,
+        SAVE_BIN,
+        SEVEN_ZIP,
+        ZIP,
+        RAR,
+        RAR5,
+        TAR,
+        ISO,
+        GZIP,
+        BZIP2,
+        XZ,
+        CAB,
+        WIM,
+    };
+
+    /**
+     * The number of bytes read from the start of a file to identify it.
+     *
+     * Large enough to reach the ISO 9660 volume descriptors at 0x8001.
+     */
+    constexpr size_t HEADER_SIZE = 0x9006;
+
+    namespace detail {
+        inline bool matches(const std::vector<uint8_t>& header, size_t offset, const std::string_view& signature) {
+            return header.size() >= offset + signature.size() &&
+                   std::memcmp(header.data() + offset, signature.data(), signature.size()) == 0;
+        }
+    }
+
+    /**
+     * Identifies the format of a file from the signature at its start.
+     *
+     * @param header the first bytes of the file; see {#HEADER_SIZE}.
+     * @return the format of the file, or {@code UNKNOWN}.
+     */
+    inline InputFormat detect(const std::vector<uint8_t>& header) {
+        using namespace std::string_view_literals;
+
+        using detail::matches;
+
+        // Xbox 360 saves are STFS packages, signed by the console ("CON ") or by Microsoft.
+        if (matches(header, 0, "CON "sv) || matches(header, 0, "LIVE"sv) || matches(header, 0, "PIRS"sv)) {
+            return InputFormat::SAVE_BIN;
+        }
+
+        if (matches(header, 0, "7z\xBC\xAF\x27\x1C"sv)) {
+            return InputFormat::SEVEN_ZIP;
+        }
+
+        if (matches(header, 0, "PK\x03\x04"sv) || matches(header, 0, "PK\x05\x06"sv) || matches(header, 0, "PK\x07\x08"sv)) {
+            return InputFormat::ZIP;
+        }
+
+        if (matches(header, 0, "Rar!\x1A\x07\x01\x00"sv)) {
+            return InputFormat::RAR5;
+        }
+
+        if (matches(header, 0, "Rar!\x1A\x07\x00"sv)) {
+            return InputFormat::RAR;
+        }
+
+        if (matches(header, 0, "\x1F\x8B"sv)) {
+            return InputFormat::GZIP;
+        }
+
+        if (matches(header, 0, "BZh"sv)) {
+            return InputFormat::BZIP2;
+        }
+
+        if (matches(header, 0, "\xFD" "7zXZ\x00"sv)) {
+            return InputFormat::XZ;
+        }
+
+        if (matches(header, 0, "MSCF"sv)) {
+            return InputFormat::CAB;
+        }
+
+        if (matches(header, 0, "MSWIM\x00\x00\x00"sv)) {
+            return InputFormat::WIM;
+        }
+
+        if (matches(header, 257, "ustar"sv)) {
+            return InputFormat::TAR;
+        }
+
+        if (matches(header, 0x8001, "CD001"sv) || matches(header, 0x8801, "CD001"sv) || matches(header, 0x9001, "CD001"sv)) {
+            return InputFormat::ISO;
+        }
+
+        return InputFormat::UNKNOWN;
+    }
+
+    /**
+     * Identifies the format of a file from the signature at its start.
+     *
+     * Only the first {#HEADER_SIZE} bytes of the file are read.
+     *
+     * @param path the file to identify.
+     * @return the format of the file, or {@code UNKNOWN} if it could not be read or identified.
+     */
+    inline InputFormat detect(const std::filesystem::path& path) {
+        auto stream = std::ifstream { path, std::ios::binary };
+
+        if (!stream) {
+            return InputFormat::UNKNOWN;
+        }
+
+        std::vector<uint8_t> header(HEADER_SIZE);
+
+        stream.read(reinterpret_cast<char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        header.resize(static_cast<size_t>(stream.gcount()));
+
+        return detect(header);
+    }
+
+    /**
+     * @param format the format to check.
+     * @return whether the format is an archive bit7z can read.
+     */
+    inline bool is_archive(InputFormat format) {
+        return format != InputFormat::UNKNOWN && format != InputFormat::SAVE_BIN;
+    }
+
+    /**
+     * Maps an archive format to its bit7z format, so bit7z does not probe the archive again.
+     *
+     * @param format the archive format.
+     * @return the bit7z format.
+     */
+    inline const bit7z::BitInFormat& to_bit7z(InputFormat format) {
+        switch (format) {
+            case InputFormat::SEVEN_ZIP: return bit7z::BitFormat::SevenZip;
+            case InputFormat::ZIP: return bit7z::BitFormat::Zip;
+            case InputFormat::RAR: return bit7z::BitFormat::Rar;
+            case InputFormat::RAR5: return bit7z::BitFormat::Rar5;
+            case InputFormat::TAR: return bit7z::BitFormat::Tar;
+            case InputFormat::ISO: return bit7z::BitFormat::Iso;
+            case InputFormat::GZIP: return bit7z::BitFormat::GZip;
+            case InputFormat::BZIP2: return bit7z::BitFormat::BZip2;
+            case InputFormat::XZ: return bit7z::BitFormat::Xz;
+            case InputFormat::CAB: return bit7z::BitFormat::Cab;
+            case InputFormat::WIM: return bit7z::BitFormat::Wim;
+            default: return bit7z::BitFormat::Auto;
+        }
+    }
+
+    /**
+     * @param format the format to name.
+     * @return a human-readable name of the format.
+     */
+    inline std::wstring to_wstring(InputFormat format) {
+        switch (format) {
+            case InputFormat::SAVE_BIN: return L"Xbox 360 save";
+            case InputFormat::SEVEN_ZIP: return L"7z";
+            case InputFormat::ZIP: return L"zip";
+            case InputFormat::RAR: return L"rar";
+            case InputFormat::RAR5: return L"rar5";
+            case InputFormat::TAR: return L"tar";
+            case InputFormat::ISO: return L"iso";
+            case InputFormat::GZIP: return L"gzip";
+            case InputFormat::BZIP2: return L"bzip2";
+            case InputFormat::XZ: return L"xz";
+            case InputFormat::CAB: return L"cab";
+            case InputFormat::WIM: return L"wim";
+            default: return L"unknown";
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef X360MSE_GOVERNOR_H
+#define X360MSE_GOVERNOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "metrics.h"
+
+namespace x360mse::governor {
+    class MemoryGovernor;
+
+    /**
+     * Tracks the memory taken by a single conversion, from when it is
+     * created until it is ended or destroyed.
+     */
+    class MemoryWatch {
+    public:
+        MemoryWatch(MemoryGovernor* owner, uint64_t id) : owner_(owner), id_(id) {
+        }
+
+        MemoryWatch(const MemoryWatch&) = delete;
+        MemoryWatch& operator=(const MemoryWatch&) = delete;
+
+        MemoryWatch(MemoryWatch&& other) noexcept
+                : owner_(std::exchange(other.owner_, nullptr)), id_(other.id_) {
+        }
+
+        ~MemoryWatch() {
+            end();
+        }
+
+        /**
+         * Stops tracking the conversion, and teaches the governor its footprint.
+         *
+         * @return the peak memory the conversion added to the process in bytes.
+         */
+        uint64_t end();
+
+    private:
+        MemoryGovernor* owner_;
+        uint64_t id_;
+    };
+
+    /**
+     * Estimates the memory conversions take, and admits them only while the
+     * estimates of the running ones fit in a memory budget.
+     *
+     * Footprints are estimated from the size of the save, times the largest
+     * ratio of memory to save size measured over the last conversions; until
+     * a conversion was measured, a conservative ratio is assumed. Memory is
+     * measured by sampling the resident memory of the process while the
+     * conversion runs, above what it was when it started. Conversions running
+     * next to each other are not told apart, so measurements err on the
+     * high side. Memory freed by earlier conversions but kept by the allocator
+     * raises the baseline of later ones, so their measurements err on the low
+     * side instead; the ratio is therefore never assumed below a floor, nor
+     * below a fraction of the highest ratio measured during the run.
+     *
+     * Memory the resident size does not show, or that no running conversion
+     * takes, is held against the budget separately: saves held in memory
+     * while they wait for their conversion, saves exposed to the converter
+     * through memory files, and scratch folders on a RAM-backed file system.
+     *
+     * A conversion is always admitted when none is running, so saves larger
+     * than the budget still get converted, one at a time.
+     */
+    class MemoryGovernor {
+    public:
+        /**
+         * The smallest footprint assumed for a conversion.
+         */
+        static constexpr uint64_t MIN_FOOTPRINT = 64ull * 1024 * 1024;
+
+        /**
+         * The ratio of memory to save size assumed before any conversion was measured.
+         */
+        static constexpr double INITIAL_RATIO = 16.0;
+
+        /**
+         * The smallest ratio of memory to save size assumed once conversions were measured.
+         */
+        static constexpr double MIN_RATIO = INITIAL_RATIO / 4;
+
+        /**
+         * The fraction of the highest ratio measured during the run below which the ratio is never assumed.
+         */
+        static constexpr double PEAK_FRACTION = 0.5;
+
+        /**
+         * How much the measured ratio is inflated by, to absorb variance between saves.
+         */
+        static constexpr double MARGIN = 1.25;
+
+        /**
+         * Saves smaller than this are not measured, as the fixed costs of the converter dominate.
+         */
+        static constexpr uintmax_t MIN_MEASURED_SIZE = 1024 * 1024;
+
+        /**
+         * The number of measured conversions estimates are drawn from.
+         */
+        static constexpr size_t HISTORY_SIZE = 16;
+
+        /**
+         * @param budget the bytes of memory running conversions may take in total; if unset, every conversion is admitted.
+         */
+        explicit MemoryGovernor(std::optional<uint64_t> budget) : budget_(budget) {
+        }
+
+        MemoryGovernor(const MemoryGovernor&) = delete;
+        MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+        ~MemoryGovernor() {
+            {
+                std::lock_guard lock(mutex_);
+                stopped_ = true;
+            }
+
+            condition_.notify_all();
+
+            if (sampler_.joinable()) {
+                sampler_.join();
+            }
+        }
+
+        /**
+         * @return the bytes of memory running conversions may take in total, if limited.
+         */
+        [[nodiscard]] std::optional<uint64_t> budget() const {
+            return budget_;
+        }
+
+        /**
+         * @param save_size the size of the save in bytes.
+         * @return the bytes of memory the conversion of the save is expected to take.
+         */
+        [[nodiscard]] uint64_t estimate(uintmax_t save_size) const {
+            std::lock_guard lock(mutex_);
+
+            const auto ratio = ratios_.empty() ?
+                    INITIAL_RATIO :
+                    std::max({ *std::ranges::max_element(ratios_) * MARGIN, peak_ratio_ * PEAK_FRACTION, MIN_RATIO });
+
+            return std::max(MIN_FOOTPRINT, static_cast<uint64_t>(static_cast<double>(save_size) * ratio));
+        }
+
+        /**
+         * @param footprint the bytes of memory the conversion is expected to take.
+         * @return whether the conversion may start now.
+         */
+        [[nodiscard]] bool admits(uint64_t footprint) const {
+            std::lock_guard lock(mutex_);
+
+            return !budget_ || reserved_ == 0 || reserved_ + held_ + footprint <= *budget_;
+        }
+
+        /**
+         * Reserves memory for a conversion about to start.
+         *
+         * @param footprint the bytes of memory the conversion is expected to take.
+         */
+        void reserve(uint64_t footprint) {
+            std::lock_guard lock(mutex_);
+
+            reserved_ += footprint;
+        }
+
+        /**
+         * Hands back the memory reserved for a conversion that ended.
+         *
+         * @param footprint the bytes of memory reserved for the conversion.
+         */
+        void release(uint64_t footprint) {
+            std::lock_guard lock(mutex_);
+
+            reserved_ -= std::min(reserved_, footprint);
+        }
+
+        /**
+         * Holds memory taken outside of the running conversions, or not shown by the resident size.
+         *
+         * @param bytes the bytes of memory to hold.
+         */
+        void hold(uint64_t bytes) {
+            std::lock_guard lock(mutex_);
+
+            held_ += bytes;
+        }
+
+        /**
+         * Holds memory only if it fits in the budget next to the running conversions and the memory held already.
+         *
+         * @param bytes the bytes of memory to hold.
+         * @return whether the memory was held.
+         */
+        bool try_hold(uint64_t bytes) {
+            std::lock_guard lock(mutex_);
+
+            if (budget_ && reserved_ + held_ + bytes > *budget_) {
+                return false;
+            }
+
+            held_ += bytes;
+
+            return true;
+        }
+
+        /**
+         * Hands back memory held through {@code hold} or {@code try_hold}.
+         *
+         * @param bytes the bytes of memory held.
+         */
+        void drop(uint64_t bytes) {
+            std::lock_guard lock(mutex_);
+
+            held_ -= std::min(held_, bytes);
+        }
+
+        /**
+         * Starts tracking the memory taken by a conversion.
+         *
+         * @param save_size the size of the save in bytes.
+         * @return the watch of the conversion; ends tracking when destroyed.
+         */
+        MemoryWatch watch(uintmax_t save_size) {
+            const auto baseline = x360mse::metrics::current_rss_bytes();
+
+            std::lock_guard lock(mutex_);
+
+            const auto id = next_id_++;
+
+            probes_[id] = Probe { save_size, baseline, baseline };
+
+            // Sample from a dedicated thread, started with the first conversion.
+            if (!sampler_.joinable()) {
+                sampler_ = std::thread([this]() { sample(); });
+            }
+
+            return { this, id };
+        }
+
+    private:
+        friend class MemoryWatch;
+
+        static constexpr auto SAMPLE_INTERVAL = std::chrono::milliseconds(50);
+
+        struct Probe {
+            uintmax_t save_size;
+            uint64_t baseline;
+            uint64_t peak;
+        };
+
+        void sample() {
+            std::unique_lock lock(mutex_);
+
+            while (!stopped_) {
+                if (!probes_.empty()) {
+                    lock.unlock();
+                    const auto resident = x360mse::metrics::current_rss_bytes();
+                    lock.lock();
+
+                    for (auto& [id, probe] : probes_) {
+                        probe.peak = std::max(probe.peak, resident);
+                    }
+                }
+
+                condition_.wait_for(lock, SAMPLE_INTERVAL, [&]() { return stopped_; });
+            }
+        }
+
+        uint64_t end(uint64_t id) {
+            const auto resident = x360mse::metrics::current_rss_bytes();
+
+            std::lock_guard lock(mutex_);
+
+            const auto probe = probes_.find(id);
+
+            if (probe == probes_.end()) {
+                return 0;
+            }
+
+            const auto peak = std::max(probe->second.peak, resident);
+            const auto footprint = peak > probe->second.baseline ? peak - probe->second.baseline : 0;
+
+            if (probe->second.save_size >= MIN_MEASURED_SIZE && resident != 0) {
+                const auto ratio = static_cast<double>(footprint) / static_cast<double>(probe->second.save_size);
+
+                ratios_.push_back(ratio);
+                peak_ratio_ = std::max(peak_ratio_, ratio);
+
+                if (ratios_.size() > HISTORY_SIZE) {
+                    ratios_.pop_front();
+                }
+            }
+
+            probes_.erase(probe);
+
+            return footprint;
+        }
+
+        const std::optional<uint64_t> budget_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable condition_;
+        std::thread sampler_;
+        std::map<uint64_t, Probe> probes_;
+        std::deque<double> ratios_;
+        double peak_ratio_ = 0;
+
+        uint64_t reserved_ = 0;
+        uint64_t held_ = 0;
+        uint64_t next_id_ = 0;
+        bool stopped_ = false;
+    };
+
+    inline uint64_t MemoryWatch::end() {
+        if (!owner_) {
+            return 0;
+        }
+
+        return std::exchange(owner_, nullptr)->end(id_);
+    }
+}
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef X360MSE_HASH_H
+#define X360MSE_HASH_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace x360mse::hash {
+    /**
+     * Incremental implementation of the 64-bit xxHash (XXH64) algorithm.
+     *
+     * Fast enough to hash save files at disk speed, and stable across
+     * platforms, so hashes can be persisted.
+     */
+    class Xxh64 {
+    public:
+        explicit Xxh64(uint64_t seed = 0)
+                : seed_(seed) {
+            accumulators_ = { seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1 };
+        }
+
+        /**
+         * Hashes the specified bytes.
+         *
+         * @param data the bytes to hash.
+         * @param size the number of bytes to hash.
+         */
+        void update(const void* data, size_t size) {
+            auto input = static_cast<const uint8_t*>(data);
+
+            total_size_ += size;
+
+            // Complete the pending stripe first.
+            if (buffer_size_ > 0) {
+                const auto count = std::min(size, buffer_.size() - buffer_size_);
+
+                std::memcpy(buffer_.data() + buffer_size_, input, count);
+                buffer_size_ += count;
+                input += count;
+                size -= count;
+
+                if (buffer_size_ < buffer_.size()) {
+                    return;
+                }
+
+                consume(buffer_.data());
+                buffer_size_ = 0;
+            }
+
+            while (size >= buffer_.size()) {
+                consume(input);
+                input += buffer_.size();
+                size -= buffer_.size();
+            }
+
+            std::memcpy(buffer_.data(), input, size);
+            buffer_size_ = size;
+        }
+
+        /**
+         * @return the hash of every byte given so far.
+         */
+        [[nodiscard]] uint64_t digest() const {
+            uint64_t hash;
+
+            if (total_size_ >= buffer_.size()) {
+                const auto& [v1, v2, v3, v4] = accumulators_;
+
+                hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+                hash = merge_round(hash, v1);
+                hash = merge_round(hash, v2);
+                hash = merge_round(hash, v3);
+                hash = merge_round(hash, v4);
+            } else {
+                hash = seed_ + PRIME_5;
+            }
+
+            hash += total_size_;
+
+            auto input = buffer_.data();
+            auto size = buffer_size_;
+
+            while (size >= 8) {
+                hash ^= round(0, read64(input));
+                hash = rotl(hash, 27) * PRIME_1 + PRIME_4;
+                input += 8;
+                size -= 8;
+            }
+
+            if (size >= 4) {
+                hash ^= static_cast<uint64_t>(read32(input)) * PRIME_1;
+                hash = rotl(hash, 23) * PRIME_2 + PRIME_3;
+                input += 4;
+                size -= 4;
+            }
+
+            while (size > 0) {
+                hash ^= *input * PRIME_5;
+                hash = rotl(hash, 11) * PRIME_1;
+                input += 1;
+                size -= 1;
+            }
+
+            hash ^= hash >> 33;
+            hash *= PRIME_2;
+            hash ^= hash >> 29;
+            hash *= PRIME_3;
+            hash ^= hash >> 32;
+
+            return hash;
+        }
+
+    private:
+        static constexpr uint64_t PRIME_1 = 11400714785074694791ULL;
+        static constexpr uint64_t PRIME_2 = 14029467366897019727ULL;
+        static constexpr uint64_t PRIME_3 = 1609587929392839161ULL;
+        static constexpr uint64_t PRIME_4 = 9650029242287828579ULL;
+        static constexpr uint64_t PRIME_5 = 2870177450012600261ULL;
+
+        static uint64_t rotl(uint64_t value, int shift) {
+            return (value << shift) | (value >> (64 - shift));
+        }
+
+        static uint64_t read64(const uint8_t* input) {
+            uint64_t value = 0;
+
+            // Read as little-endian, regardless of the platform.
+            for (int i = 7; i >= 0; i -= 1) {
+                value = (value << 8) | input[i];
+            }
+
+            return value;
+        }
+
+        static uint32_t read32(const uint8_t* input) {
+            uint32_t value = 0;
+
+            for (int i = 3; i >= 0; i -= 1) {
+                value = (value << 8) | input[i];
+            }
+
+            return value;
+        }
+
+        static uint64_t round(uint64_t accumulator, uint64_t input) {
+            accumulator += input * PRIME_2;
+            accumulator = rotl(accumulator, 31);
+            accumulator *= PRIME_1;
+
+            return accumulator;
+        }
+
+        static uint64_t merge_round(uint64_t accumulator, uint64_t value) {
+            accumulator ^= round(0, value);
+            accumulator = accumulator * PRIME_1 + PRIME_4;
+
+            return accumulator;
+        }
+
+        void consume(const uint8_t* stripe) {
+            for (size_t i = 0; i < accumulators_.size(); i += 1) {
+                accumulators_[i] = round(accumulators_[i], read64(stripe + i * 8));
+            }
+        }
+
+        uint64_t seed_;
+        std::array<uint64_t, 4> accumulators_ {};
+        std::array<uint8_t, 32> buffer_ {};
+        size_t buffer_size_ = 0;
+        uint64_t total_size_ = 0;
+    };
+
+    /**
+     * Hashes the specified bytes with XXH64.
+     *
+     * @param data the bytes to hash.
+     * @param size the number of bytes to hash.
+     * @return the hash.
+     */
+    inline uint64_t xxh64(const void* data, size_t size) {
+        Xxh64 hasher;
+        hasher.update(data, size);
+
+        return hasher.digest();
+    }
+
+    /**
+     * Hashes the contents of the specified file with XXH64.
+     *
+     * @param path the file to hash.
+     * @return the hash.
+     */
+    inline uint64_t xxh64_file(const std::filesystem::path& path) {
+        auto stream = std::ifstream { path, std::ios::binary };
+
+        if (!stream) {
+            throw std::runtime_error("Failed to open file for hashing");
+        }
+
+        Xxh64 hasher;
+        std::vector<char> buffer(1 << 20);
+
+        while (stream) {
+            stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hasher.update(buffer.data(), static_cast<size_t>(stream.gcount()));
+        }
+
+        return hasher.digest();
+    }
+
+    /**
+     * Formats a hash as a fixed-width lowercase hexadecimal string.
+     *
+     * @param hash the hash to format.
+     * @return the formatted hash.
+     */
+    inline std::string to_hex(uint64_t hash) {
+        constexpr auto digits = "0123456789abcdef";
+
+        std::string text(16, '0');
+
+        for (int i = 15; i >= 0; i -= 1) {
+            text[i] = digits[hash & 0xF];
+            hash >>= 4;
+        }
+
+        return text;
+    }
+}
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef X360MSE_INVENTORY_H
+#define X360MSE_INVENTORY_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "metrics.h"
+#include "util.h"
+
+namespace x360mse::inventory {
+    /**
+     * A save found in an input, as described by its headers only.
+     */
+    struct SaveEntry {
+        /**
+         * The title of the world, if a '_MinecraftSaveInfo' file lists the save.
+         */
+        std::optional<std::string> title;
+
+        std::wstring file_name;
+
+        /**
+         * The path of the save within the input.
+         */
+        std::wstring path;
+
+        /**
+         * The bytes the save takes in the input; zero if unknown, e.g. when solid archives share them.
+         */
+        uint64_t packed_size = 0;
+
+        uint64_t size = 0;
+
+        std::optional<std::chrono::system_clock::time_point> creation_time;
+        std::optional<std::chrono::system_clock::time_point> modification_time;
+    };
+
+    namespace detail {
+        inline std::string format_time(const std::optional<std::chrono::system_clock::time_point>& time) {
+            // Archives leave unknown times at the epoch.
+            if (!time || time->time_since_epoch().count() <= 0) {
+                return "null";
+            }
+
+            const auto seconds = std::chrono::floor<std::chrono::seconds>(*time);
+            const auto days = std::chrono::floor<std::chrono::days>(seconds);
+            const auto date = std::chrono::year_month_day { days };
+            const auto clock = std::chrono::hh_mm_ss { seconds - days };
+
+            return fmt::format(
+                    "\"{:04}-{:02}-{:02}T{:02}:{:02}:{:02}Z\"",
+                    static_cast<int>(date.year()),
+                    static_cast<unsigned>(date.month()),
+                    static_cast<unsigned>(date.day()),
+                    clock.hours().count(),
+                    clock.minutes().count(),
+                    clock.seconds().count()
+            );
+        }
+    }
+
+    /**
+     * Writes the saves found in an input as JSON.
+     *
+     * @param input the input the saves were found in.
+     * @param saves the saves.
+     * @return the JSON document.
+     */
+    inline std::string to_json(const std::filesystem::path& input, const std::vector<SaveEntry>& saves) {
+        using x360mse::metrics::detail::escape_json;
+
+        std::string json;
+
+        json += "{\n";
+        json += fmt::format("  \"input\": \"{}\",\n", escape_json(x360mse::util::to_utf8(input.wstring())));
+        json += fmt::format("  \"save_count\": {},\n", saves.size());
+        json += "  \"saves\": [";
+
+        bool first_save = true;
+
+        for (const auto& save : saves) {
+            json += first_save ? "\n" : ",\n";
+            json += "    {\n";
+            json += save.title ?
+                    fmt::format("      \"title\": \"{}\",\n", escape_json(*save.title)) :
+                    std::string("      \"title\": null,\n");
+            json += fmt::format("      \"file_name\": \"{}\",\n", escape_json(x360mse::util::to_utf8(save.file_name)));
+            json += fmt::format("      \"path\": \"{}\",\n", escape_json(x360mse::util::to_utf8(save.path)));
+            json += fmt::format("      \"packed_size\": {},\n", save.packed_size);
+            json += fmt::format("      \"size\": {},\n", save.size);
+            json += fmt::format("      \"created\": {},\n", detail::format_time(save.creation_time));
+            json += fmt::format("      \"modified\": {}\n", detail::format_time(save.modification_time));
+            json += "    }";
+
+            first_save = false;
+        }
+
+        json += first_save ? "]\n" : "\n  ]\n";
+        json += "}\n";
+
+        return json;
+    }
+}
+
+#endif
@@ -0,0 +1,411 @@
+#ifndef X360MSE_JOURNAL_H
+#define X360MSE_JOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/core.h>
+
+// If on Windows, journal records are flushed to disk through '_commit';
+// elsewhere, through 'fsync'.
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "util.h"
+
+namespace x360mse::journal {
+    /**
+     * How far a save has come through a run.
+     */
+    enum class State {
+        DISCOVERED,
+        EXTRACTED,
+        CONVERTED,
+        FINALIZED,
+    };
+
+    /**
+     * @param state the state to name.
+     * @return the name of the state in the journal.
+     */
+    inline const char* to_string(State state) {
+        switch (state) {
+            case State::DISCOVERED: return "discovered";
+            case State::EXTRACTED: return "extracted";
+            case State::CONVERTED: return "converted";
+            case State::FINALIZED: return "finalized";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * @param name the name of a state in the journal.
+     * @return the state, if the name is known.
+     */
+    inline std::optional<State> parse_state(const std::string& name) {
+        for (const auto state : { State::DISCOVERED, State::EXTRACTED, State::CONVERTED, State::FINALIZED }) {
+            if (name == to_string(state)) {
+                return state;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    /**
+     * Identifies a save by where it was read from, so it can be recognized
+     * in a later run before it is extracted or copied again.
+     *
+     * @param input the input the save was read from: a folder, an archive or a disk image.
+     * @param item the path of the save within the input.
+     * @param size the size of the save in bytes.
+     * @param stamp anything else telling versions of the save apart, e.g. its checksum or modification time.
+     * @return the origin of the save.
+     */
+    inline std::string origin(const std::filesystem::path& input, const std::string& item, uintmax_t size, uint64_t stamp) {
+        std::error_code error;
+        const auto absolute_input = std::filesystem::absolute(input, error);
+
+        return fmt::format("{}|{}|{}|{:x}", x360mse::util::to_utf8((error ? input : absolute_input).lexically_normal().wstring()), item, size, stamp);
+    }
+
+    /**
+     * The last state recorded for a save, and the files it produced so far.
+     */
+    struct Entry {
+        State state = State::DISCOVERED;
+
+        /**
+         * The save file kept in the output folder, if any.
+         */
+        std::filesystem::path save_path;
+
+        /**
+         * The folder, or the archive, the save is converted into, once reserved.
+         */
+        std::filesystem::path output_path;
+    };
+
+    /**
+     * Records how far each save of a run has come in the output folder, so
+     * an interrupted run can be resumed without redoing finished work.
+     *
+     * Records are appended as lines and flushed to disk one by one, so at
+     * most the record being written when the run died is lost; a torn last
+     * line is ignored when the journal is read back, and cut off before new
+     * records are appended. The journal starts
+     * with the settings of the run, and is only resumed from if they match.
+     * Recording is thread-safe.
+     */
+    class Journal {
+    public:
+        static constexpr auto FILE_NAME = ".x360mse-journal";
+
+        /**
+         * Opens the journal of an output folder.
+         *
+         * @param output_directory the output folder of the run.
+         * @param settings the settings changing the outputs of the run, e.g. level overrides.
+         * @param resume whether to resume from the journal left by an earlier run; otherwise, it is discarded.
+         */
+        Journal(const std::filesystem::path& output_directory, const std::string& settings, bool resume)
+                : path_(output_directory / FILE_NAME) {
+            const auto header = fmt::format("x360mse-journal 1 {}", settings);
+
+            if (resume) {
+                load(header);
+            }
+
+            // On Windows, narrow paths go through the code page, which cannot hold every file name.
+#ifdef _WIN32
+            file_ = _wfopen(path_.c_str(), entries_.empty() ? L"wb" : L"ab");
+#else
+            file_ = std::fopen(path_.c_str(), entries_.empty() ? "wb" : "ab");
+#endif
+
+            if (!file_) {
+                throw std::runtime_error("Failed to open journal " + x360mse::util::to_utf8(path_.wstring()));
+            }
+
+            if (entries_.empty()) {
+                append(escape(header) + "\n");
+            }
+        }
+
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+
+        ~Journal() {
+            if (file_) {
+                std::fclose(file_);
+            }
+        }
+
+        /**
+         * @return the path of the journal.
+         */
+        [[nodiscard]] const std::filesystem::path& path() const {
+            return path_;
+        }
+
+        /**
+         * @return the number of saves known from an earlier run.
+         */
+        [[nodiscard]] size_t resumed_count() const {
+            return resumed_count_;
+        }
+
+        /**
+         * @param origin the origin of the save.
+         * @return the last state recorded for the save, if any.
+         */
+        [[nodiscard]] std::optional<Entry> find(const std::string& origin) const {
+            std::lock_guard lock(mutex_);
+
+            const auto entry = entries_.find(origin);
+
+            if (entry == entries_.end()) {
+                return std::nullopt;
+            }
+
+            return entry->second;
+        }
+
+        /**
+         * @param origin the origin of the save.
+         * @return whether the save was fully converted, and its output is still there.
+         */
+        [[nodiscard]] bool finished(const std::string& origin) const {
+            const auto entry = find(origin);
+
+            return entry && entry->state == State::FINALIZED && !entry->output_path.empty() && std::filesystem::exists(entry->output_path);
+        }
+
+        /**
+         * @param origin the origin of the save.
+         * @param size the size of the save in bytes.
+         * @return the save file kept in the output folder by an earlier run, if it is still there.
+         */
+        [[nodiscard]] std::optional<std::filesystem::path> kept_save(const std::string& origin, uintmax_t size) const {
+            const auto entry = find(origin);
+
+            if (!entry || entry->state < State::EXTRACTED || entry->save_path.empty()) {
+                return std::nullopt;
+            }
+
+            std::error_code error;
+            const auto kept_size = std::filesystem::file_size(entry->save_path, error);
+
+            if (error || kept_size != size) {
+                return std::nullopt;
+            }
+
+            return entry->save_path;
+        }
+
+        /**
+         * Records that saves were discovered, with a single flush.
+         *
+         * Saves already known from an earlier run are left as they are.
+         *
+         * @param origins the origins of the saves.
+         */
+        void discover(const std::vector<std::string>& origins) {
+            std::lock_guard lock(mutex_);
+
+            std::string lines;
+
+            for (const auto& origin : origins) {
+                if (entries_.emplace(origin, Entry {}).second) {
+                    lines += format_line(origin, entries_[origin]);
+                }
+            }
+
+            if (!lines.empty()) {
+                append(lines);
+            }
+        }
+
+        /**
+         * Records the state of a save.
+         *
+         * Paths left empty keep their last recorded value.
+         *
+         * @param origin the origin of the save.
+         * @param state the state the save has reached.
+         * @param save_path the save file kept in the output folder, if any.
+         * @param output_path the folder, or the archive, the save is converted into, if reserved.
+         */
+        void record(const std::string& origin, State state, const std::filesystem::path& save_path = {}, const std::filesystem::path& output_path = {}) {
+            std::lock_guard lock(mutex_);
+
+            auto& entry = entries_[origin];
+            entry.state = state;
+
+            if (!save_path.empty()) {
+                entry.save_path = save_path;
+            }
+
+            if (!output_path.empty()) {
+                entry.output_path = output_path;
+            }
+
+            append(format_line(origin, entry));
+        }
+
+    private:
+        static std::string escape(const std::string& text) {
+            std::string escaped;
+            escaped.reserve(text.size());
+
+            for (const auto character : text) {
+                switch (character) {
+                    case '\\': escaped += "\\\\"; break;
+                    case '\t': escaped += "\\t"; break;
+                    case '\n': escaped += "\\n"; break;
+                    case '\r': escaped += "\\r"; break;
+                    default: escaped += character;
+                }
+            }
+
+            return escaped;
+        }
+
+        static std::string unescape(const std::string& text) {
+            std::string unescaped;
+            unescaped.reserve(text.size());
+
+            for (size_t i = 0; i < text.size(); i += 1) {
+                if (text[i] != '\\' || i + 1 == text.size()) {
+                    unescaped += text[i];
+                    continue;
+                }
+
+                switch (text[++i]) {
+                    case 't': unescaped += '\t'; break;
+                    case 'n': unescaped += '\n'; break;
+                    case 'r': unescaped += '\r'; break;
+                    default: unescaped += text[i];
+                }
+            }
+
+            return unescaped;
+        }
+
+        static std::string format_line(const std::string& origin, const Entry& entry) {
+            return fmt::format(
+                    "{}\t{}\t{}\t{}\n",
+                    to_string(entry.state),
+                    escape(origin),
+                    escape(x360mse::util::to_utf8(entry.save_path.wstring())),
+                    escape(x360mse::util::to_utf8(entry.output_path.wstring()))
+            );
+        }
+
+        static std::vector<std::string> split(const std::string& line) {
+            std::vector<std::string> fields;
+            size_t start = 0;
+
+            while (true) {
+                const auto end = line.find('\t', start);
+
+                fields.push_back(unescape(line.substr(start, end - start)));
+
+                if (end == std::string::npos) {
+                    return fields;
+                }
+
+                start = end + 1;
+            }
+        }
+
+        void load(const std::string& header) {
+            auto stream = std::ifstream { path_, std::ios::binary };
+
+            if (!stream) {
+                return;
+            }
+
+            std::string contents { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+            const auto file_size = contents.size();
+
+            stream.close();
+
+            // Drop a line torn by a crash while it was being written.
+            contents.erase(contents.find_last_of('\n') == std::string::npos ? 0 : contents.find_last_of('\n') + 1);
+
+            size_t start = 0;
+            bool header_matched = false;
+
+            while (start < contents.size()) {
+                const auto end = contents.find('\n', start);
+                const auto line = contents.substr(start, end - start);
+
+                start = end + 1;
+
+                if (!header_matched) {
+                    // The outputs of a run with other settings cannot be reused.
+                    if (unescape(line) != header) {
+                        return;
+                    }
+
+                    header_matched = true;
+                    continue;
+                }
+
+                const auto fields = split(line);
+                const auto state = fields.size() == 4 ? parse_state(fields[0]) : std::nullopt;
+
+                if (!state) {
+                    continue;
+                }
+
+                auto& entry = entries_[fields[1]];
+                entry.state = *state;
+                entry.save_path = std::filesystem::path(x360mse::util::to_wstring(fields[2]));
+                entry.output_path = std::filesystem::path(x360mse::util::to_wstring(fields[3]));
+            }
+
+            resumed_count_ = entries_.size();
+
+            // Cut the torn line off the file too, as new records are appended to it; otherwise,
+            // the first one would be glued to it, and dropped along with it by the next resume.
+            if (!entries_.empty() && contents.size() < file_size) {
+                std::filesystem::resize_file(path_, contents.size());
+            }
+        }
+
+        void append(const std::string& lines) {
+            if (std::fwrite(lines.data(), 1, lines.size(), file_) != lines.size() || std::fflush(file_) != 0) {
+                throw std::runtime_error("Failed to write journal " + x360mse::util::to_utf8(path_.wstring()));
+            }
+
+            // Make the record survive a power loss, not only a crash.
+#ifdef _WIN32
+            _commit(_fileno(file_));
+#else
+            fsync(fileno(file_));
+#endif
+        }
+
+        std::filesystem::path path_;
+        std::FILE* file_ = nullptr;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> entries_;
+        size_t resumed_count_ = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef X360MSE_LEVEL_H
+#define X360MSE_LEVEL_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <minecraft-file.hpp>
+
+namespace x360mse::level {
+    /**
+     * An edit of the 'Data' tag of a converted world's 'level.dat'.
+     *
+     * Every hook of a world is applied in a single pass, so 'level.dat' is only
+     * decompressed, parsed and compressed again once, however many are set.
+     */
+    using LevelHook = std::function<void(mcfile::nbt::CompoundTag& data)>;
+
+    /**
+     * A spawn point of a world.
+     */
+    struct Spawn {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+    };
+
+    /**
+     * The overrides applied to every converted world, set in bulk from the command line.
+     */
+    struct LevelOverrides {
+        std::optional<Spawn> spawn;
+        std::map<std::string, std::string> game_rules;
+
+        /**
+         * Parses a spawn point.
+         *
+         * @param text the spawn point, as 'x,y,z'.
+         * @return the spawn point.
+         * @throws std::invalid_argument if the text is not a spawn point.
+         */
+        static Spawn parse_spawn(const std::string& text) {
+            Spawn spawn {};
+            size_t offset = 0;
+
+            for (auto* coordinate : { &spawn.x, &spawn.y, &spawn.z }) {
+                const auto end = coordinate == &spawn.z ? text.size() : text.find(',', offset);
+
+                if (end == std::string::npos) {
+                    throw std::invalid_argument("Spawn must be given as x,y,z: " + text);
+                }
+
+                size_t parsed = 0;
+                *coordinate = std::stoi(text.substr(offset, end - offset), &parsed);
+
+                if (parsed != end - offset) {
+                    throw std::invalid_argument("Spawn must be given as x,y,z: " + text);
+                }
+
+                offset = end + 1;
+            }
+
+            return spawn;
+        }
+
+        /**
+         * Parses a game rule.
+         *
+         * @param text the game rule, as 'name=value'.
+         * @return the name and value of the game rule.
+         * @throws std::invalid_argument if the text is not a game rule.
+         */
+        static std::pair<std::string, std::string> parse_game_rule(const std::string& text) {
+            const auto separator = text.find('=');
+
+            if (separator == std::string::npos || separator == 0) {
+                throw std::invalid_argument("Game rules must be given as name=value: " + text);
+            }
+
+            return { text.substr(0, separator), text.substr(separator + 1) };
+        }
+
+        /**
+         * @return a string identifying the overrides, to tell worlds converted with different ones apart.
+         */
+        [[nodiscard]] std::string fingerprint() const {
+            std::string fingerprint;
+
+            if (spawn) {
+                fingerprint += "spawn=" + std::to_string(spawn->x) + "," + std::to_string(spawn->y) + "," + std::to_string(spawn->z) + ";";
+            }
+
+            for (const auto& [name, value] : game_rules) {
+                fingerprint += "rule:" + name + "=" + value + ";";
+            }
+
+            return fingerprint;
+        }
+
+        /**
+         * @return the hooks applying the overrides.
+         */
+        [[nodiscard]] std::vector<LevelHook> hooks() const {
+            std::vector<LevelHook> hooks;
+
+            if (spawn) {
+                hooks.emplace_back([spawn = *spawn](mcfile::nbt::CompoundTag& data) {
+                    data.set(u8"SpawnX", std::make_shared<mcfile::nbt::IntTag>(spawn.x));
+                    data.set(u8"SpawnY", std::make_shared<mcfile::nbt::IntTag>(spawn.y));
+                    data.set(u8"SpawnZ", std::make_shared<mcfile::nbt::IntTag>(spawn.z));
+                });
+            }
+
+            if (!game_rules.empty()) {
+                hooks.emplace_back([game_rules = game_rules](mcfile::nbt::CompoundTag& data) {
+                    auto rules = data.compoundTag(u8"GameRules");
+
+                    if (!rules) {
+                        rules = std::make_shared<mcfile::nbt::CompoundTag>();
+                        data.set(u8"GameRules", rules);
+                    }
+
+                    // Game rules are stored as strings, whatever their type.
+                    for (const auto& [name, value] : game_rules) {
+                        rules->set(std::u8string(name.begin(), name.end()), std::u8string(value.begin(), value.end()));
+                    }
+                });
+            }
+
+            return hooks;
+        }
+    };
+
+    /**
+     * Creates the hook setting the name of a world.
+     *
+     * @param level_name the name of the world, as UTF-8; usually the title from its save bin.
+     * @return the hook.
+     */
+    inline LevelHook set_level_name(const std::string& level_name) {
+        return [level_name = std::u8string(level_name.begin(), level_name.end())](mcfile::nbt::CompoundTag& data) {
+            data.set(u8"LevelName", level_name);
+        };
+    }
+}
+
+#endif
@@ -1,16 +1,10 @@
 #include <iostream>
-#include <fstream>
-#include <regex>
 #include <filesystem>
 #include <vector>
 #include <string>
-#include <locale>
-#include <codecvt>
-
-#include "bit7z/bit7zlibrary.hpp"
-#include "bit7z/bitarchivereader.hpp"
-#include "bit7z/bitextractor.hpp"
-#include "bit7z/bitfileextractor.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
 
 #include <cxxopts.hpp>
 
@@ -28,715 +22,698 @@
 #include <fmt/xchar.h>
 #include <fmt/color.h>
 
-#include <je2be.hpp>
-
-#include "../je2be-core/example/lce-progress.hpp"
-
-#include <minecraft-file.hpp>
-
+#include "archive.h"
+#include "batch.h"
+#include "converter.h"
+#include "edition.h"
+#include "events.h"
+#include "inventory.h"
+#include "level.h"
+#include "nesting.h"
+#include "progress.h"
+#include "selection.h"
 #include "util.h"
+#include "watch.h"
 #include "unicode.hpp"
 
 
 // Shorten the namespaces for ease of use.
 namespace uc = unicode;
+namespace pg = x360mse::progress;
 
-bool set_level_name(const std::filesystem::path& level_dat_path, const std::string& new_level_name) {
-    // Check if the level.dat file exists.
-    if (!std::filesystem::exists(level_dat_path)) {
-        fmt::println(
-                L"{}",
-                fmt::styled(
-                        std::format(L"{} {}: {}", uc::X, L"[Error] File does not exist", level_dat_path.wstring()),
-                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                ));
-
-        return false;
-    }
-
-    // Read the level.dat file.
-    auto in_stream = std::make_shared<mcfile::stream::GzFileInputStream>(level_dat_path);
-    auto in_root = mcfile::nbt::CompoundTag::Read(in_stream, mcfile::Endian::Big);
-
-    in_stream.reset();
-
-    if (!in_root) {
-        fmt::println(
-                L"{}",
-                fmt::styled(
-                        std::format(L"{} {}: {}", uc::X, L"[Error] Failed to read file", level_dat_path.wstring()),
-                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                ));
+/**
+ * Prints the events of the inputs as they are reported, and draws their jobs as progress bars.
+ *
+ * Events are reported from the threads reading and converting the inputs.
+ */
+class EventPrinter {
+public:
+    /**
+     * Prints an event.
+     *
+     * @param event the event.
+     */
+    void operator()(const x360mse::events::Event& event) {
+        using x360mse::events::EventType;
+
+        switch (event.type) {
+            case EventType::INPUT_STARTED:
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {}",
+                                   fmt::styled(label(uc::RIGHTWARDS_HEAVY_ARROW, event) + L" ", fmt::fg(fmt::color::cyan)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white))
+                           ));
 
-        return false;
-    }
+                pg::println(L"");
+                break;
 
-    // Access the "Data" compound tag.
-    auto data_tag = in_root->compoundTag(u8"Data");
-    if (!data_tag) {
-        fmt::println(
-                L"{}",
-                fmt::styled(
-                        std::format(L"{} {}: {}", uc::X, L"[Error] File does not contain 'Data' tag", level_dat_path.wstring()),
-                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                ));
+            case EventType::RUN_RESUMED:
+            case EventType::INPUT_DETECTED:
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {}",
+                                   fmt::styled(label(uc::RIGHTWARDS_HEAVY_ARROW, event), fmt::fg(fmt::color::green_yellow)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white))
+                           ));
 
-        return false;
-    }
+                pg::println(L"");
+                break;
 
-    // Convert new_level_name from std::string to u8string.
-    std::u8string u8_new_level_name(new_level_name.begin(), new_level_name.end());
+            case EventType::SAVE_INFO_FOUND: {
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {}",
+                                   fmt::styled(label(uc::RIGHTWARDS_HEAVY_ARROW, event), fmt::fg(fmt::color::green_yellow)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white))
+                           ));
+                pg::println(L"");
 
-    // Set the new level name
-    data_tag->set(u8"LevelName", u8_new_level_name);
+                size_t detail_index = 0;
 
-    // Write the modified data back to the file.
-    auto out_stream = std::make_shared<mcfile::stream::GzFileOutputStream>(level_dat_path);
-    if (!mcfile::nbt::CompoundTag::Write(*in_root, out_stream, mcfile::Endian::Big)) {
-        fmt::println(
-                L"{}",
-                fmt::styled(
-                        std::format(L"{} {}: {}", uc::X, L"[Error] Failed to write updated file", level_dat_path.wstring()),
-                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                ));
+                for (const auto& detail : event.details) {
+                    pg::println(L"{}",
+                               fmt::format(
+                                       L"{} {}",
+                                       fmt::styled(fmt::format(L"{} [{} / {}]", uc::RIGHTWARDS_HEAVY_ARROW, detail_index + 1, event.details.size()), fmt::fg(fmt::color::light_pink)),
+                                       fmt::styled(detail, fmt::fg(fmt::color::white))
+                               ));
 
-        return false;
-    }
+                    detail_index += 1;
+                }
 
-    return true;
-}
+                pg::println(L"");
+                break;
+            }
 
+            case EventType::SAVES_DISCOVERED:
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {} {}",
+                                   fmt::styled(label(uc::RIGHTWARDS_HEAVY_ARROW, event), fmt::fg(fmt::color::green_yellow)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white)),
+                                   fmt::styled(fmt::format(L"({}ms)", event.duration.value_or(std::chrono::milliseconds(0)).count()), fmt::fg(fmt::color::green_yellow))
+                           ));
 
-/**
- * Generates a unique path in the specified directory with the specified name.
- *
- * If a file already exists with the same name, it will append a number to the name.
- * Otherwise, it will return the path as is.
- *
- * @param directory the directory to generate the unique path in.
- * @param name the name of the file.
- * @return the unique path.
- */
-std::wstring unique_path(const std::filesystem::path& directory, const std::filesystem::path& name) {
-    auto path = directory / name;
+                pg::println(L"");
+                break;
 
-    if (!std::filesystem::exists(path)) {
-        return path.wstring();
-    }
+            case EventType::SAVE_READ:
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {} {}",
+                                   fmt::styled(label(uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, event), fmt::fg(fmt::color::green_yellow)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white)),
+                                   fmt::styled(fmt::format(L"({}ms)", event.duration.value_or(std::chrono::milliseconds(0)).count()), fmt::fg(fmt::color::green_yellow))
+                           ));
+                break;
 
-    int counter = 1;
+            case EventType::SAVE_SKIPPED:
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {}",
+                                   fmt::styled(label(uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, event), fmt::fg(fmt::color::green_yellow)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white))
+                           ));
+                break;
 
-    auto stem = path.stem().string();
-    auto extension = path.extension().string();
+            case EventType::CONVERSION_STARTED:
+                pg::println(L"");
 
-    while (std::filesystem::exists(path)) {
-        counter += 1;
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {}",
+                                   fmt::styled(label(uc::RIGHTWARDS_HEAVY_ARROW, event) + L" ", fmt::fg(fmt::color::cyan)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white))
+                           ));
 
-        // Append the counter to the stem of the path.
-        // Ex.: "file (1).bin", "file (2).bin", etc.
-        path = directory / std::filesystem::path(stem + " (" + std::to_string(counter) + ")" + extension);
-    }
+                pg::println(L"");
+                break;
 
-    return path.wstring();
-}
+            case EventType::SAVE_CONVERTED:
+                // Saves reused or resumed were not converted, so they have no duration.
+                if (!event.duration) {
+                    pg::println(L"");
 
-/**
- * Converts the specified file from a Minecraft Xbox 360 Edition
- * to a Minecraft Java Edition save file.
- *
- * The conversion outputs the save as an uncompressed folder.
- *
- * @param file_path the file to convert.
- * @param output_path the directory to write to.
- * @param file_index the index of the file in the total.
- * @param file_total the total number of files to convert.
- */
-void convert_file(
-        const std::filesystem::path& file_path,
-        const std::filesystem::path& output_path,
-        const size_t file_index,
-        const size_t file_total,
-        const je2be::xbox360::MinecraftSaveInfo::SaveBin& bin
-        ) {
-    try {
-        je2be::lce::Options convert_options;
+                    pg::println(L"{}",
+                               fmt::format(
+                                       L"{} {}",
+                                       fmt::styled(label(uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, event) + L" ", fmt::fg(fmt::color::green_yellow)),
+                                       fmt::styled(event.message, fmt::fg(fmt::color::white))
+                               ));
+                    break;
+                }
 
-        // Create a temporary directory to store the converted save.
-        convert_options.fTempDirectory = mcfile::File::CreateTempDir(std::filesystem::temp_directory_path());
+                pg::println(L"{}",
+                           fmt::format(
+                                   L"{} {} {}",
+                                   fmt::styled(label(uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, event) + L" ", fmt::fg(fmt::color::green_yellow)),
+                                   fmt::styled(event.message, fmt::fg(fmt::color::white)),
+                                   fmt::styled(fmt::format(L"({}ms, {} MiB)", event.duration->count(), event.memory.value_or(0) / (1024 * 1024)), fmt::fg(fmt::color::green_yellow))
+                           ));
+                break;
+
+            case EventType::SAVE_FAILED:
+                pg::eprintln(L"{}",
+                            fmt::format(
+                                    L"{} {} {}",
+                                    fmt::styled(label(uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, event) + L" ", fmt::fg(fmt::color::red)),
+                                    fmt::styled(event.message, fmt::fg(fmt::color::white)),
+                                    fmt::styled(fmt::format(L"({}ms)", event.duration.value_or(std::chrono::milliseconds(0)).count()), fmt::fg(fmt::color::red))
+                            ));
+                break;
+
+            case EventType::ERROR_OCCURRED:
+                pg::eprintln(
+                        L"{}",
+                        fmt::styled(
+                                fmt::format(L"{} [Error] {}", uc::X, event.message),
+                                fmt::fg(fmt::color::red) | fmt::emphasis::bold
+                        ));
+                break;
 
-        // Delete the temporary directory after the conversion is complete.
-        // defer uses RAII to ensure the temporary directory is deleted
-        // when the function exits.
-        defer {
-            if (convert_options.fTempDirectory) {
-                je2be::Fs::DeleteAll(*convert_options.fTempDirectory);
+            case EventType::JOB_STARTED: {
+                // The renderer reads the progress of the job in place, so progress events are not needed.
+                std::lock_guard lock(mutex_);
+                jobs_[event.job] = pg::renderer().begin_job(event.message, event.progress);
+                break;
             }
-        };
 
-        fmt::print(L"\n");
+            case EventType::JOB_PROGRESS:
+                break;
 
-        fmt::println(L"{}",
-                     fmt::format(
-                             L"{} {}",
-                             fmt::styled(fmt::format(L"{} [{} / {}] ", uc::RIGHTWARDS_HEAVY_ARROW, file_index + 1, file_total), fmt::fg(fmt::color::cyan)),
-                             fmt::styled(fmt::format(L"Converting {}...", file_path.filename().wstring()),fmt::fg(fmt::color::white))
-                     ));
-
-        fmt::print(L"\n");
-
-        // Run the conversion and measure the time it takes.
-        auto [duration_ms, status] = x360mse::util::run_measuring_ms<je2be::Status>([&]() {
-            return je2be::xbox360::Converter::Run(file_path, output_path, std::thread::hardware_concurrency(), convert_options, nullptr);
-        });
+            case EventType::JOB_ENDED: {
+                std::lock_guard lock(mutex_);
+                jobs_.erase(event.job);
+                break;
+            }
 
-        // Modify 'level.dat' of the extracted folder to match the bin data's level name.
-        const auto level_dat_path = std::filesystem::path(output_path) / "level.dat";
+            case EventType::INPUT_FINISHED:
+                break;
+        }
+    }
 
-        if (!set_level_name(level_dat_path, x360mse::util::to_string(bin.fTitle))) {
-            fmt::println(
-                    L"{}",
-                    fmt::styled(
-                            std::format(L"{} {}: {}", uc::X, L"[Error] Failed to set level name in file", level_dat_path.wstring()),
-                            fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                    ));
+private:
+    /**
+     * @param arrow the arrow leading the line.
+     * @param event the event.
+     * @return the arrow, followed by the position of the event if it has one, e.g. '➜ [2 / 5]', or '➜ [2]' while the total is unknown.
+     */
+    static std::wstring label(const std::wstring& arrow, const x360mse::events::Event& event) {
+        if (!event.position) {
+            return arrow;
         }
 
-        if (auto err = status.error(); err) {
-            fmt::println(L"{}",
-                         fmt::format(
-                                 L"{} {} {}",
-                                 fmt::styled(fmt::format(L"{} [{} / {}] ", uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, file_index + 1, file_total), fmt::fg(fmt::color::red)),
-                                 fmt::styled(fmt::format(L"Failed to convert {}!", file_path.filename().wstring()),fmt::fg(fmt::color::white)),
-                                 fmt::styled(fmt::format(L"({}ms)", duration_ms), fmt::fg(fmt::color::red))
-                         ));
-        } else {
-            fmt::println(L"{}",
-                         fmt::format(
-                                 L"{} {} {}",
-                                 fmt::styled(fmt::format(L"{} [{} / {}] ", uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, file_index + 1, file_total), fmt::fg(fmt::color::green_yellow)),
-                                 fmt::styled(fmt::format(L"Converted {}!", file_path.filename().wstring()),fmt::fg(fmt::color::white)),
-                                    fmt::styled(fmt::format(L"({}ms)", duration_ms), fmt::fg(fmt::color::green_yellow))
-                         ));
+        if (!event.position->total) {
+            return fmt::format(L"{} [{}]", arrow, event.position->index + 1);
         }
-    } catch (const std::exception& ex) {
-        fmt::println(
-                L"{}",
-                fmt::styled(
-                        std::format(L"{} {}:\n{}", uc::X, L"[Error] An exception has occurred!", x360mse::util::to_wstring(std::string(ex.what()))),
-                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                ));
+
+        return fmt::format(L"{} [{} / {}]", arrow, event.position->index + 1, *event.position->total);
     }
-}
 
-static uint64_t pep_extraction_size = 0; // Total size of the extraction.
-static size_t pep_prev_text_size = 0;
-static std::chrono::time_point<std::chrono::steady_clock> pep_last_time = std::chrono::steady_clock::now();
+    std::mutex mutex_;
 
-void set_total_size(uint64_t size) {
-    pep_extraction_size = size;
-}
+    // The jobs drawn by the renderer, by the identifiers the converter gave them.
+    std::map<uint64_t, pg::Job> jobs_;
+};
 
 /**
- * Prints the extraction progress of a bit7z::BitFileExtractor
- * into stdout.
- *
- * Must call {#set_total_size} beforehand to set the total
- * extraction size.
+ * Prints what became of an input, so the failed ones can be run again on their own.
  *
- * @param current_size the current extracted size.
+ * @param result the result of the input.
  */
-void print_extraction_progress(uint64_t current_size) {
-    if (pep_extraction_size == 0) return; // Avoid division by zero.
-
-    const auto current_time = std::chrono::steady_clock::now();
+void print_outcome(const x360mse::converter::InputResult& result) {
+    using x360mse::converter::SaveOutcome;
+
+    const auto outcome = fmt::format(
+            L"{} {}: {} of {} save(s) converted{}{}",
+            uc::BULLET_POINT,
+            result.input.path.wstring(),
+            result.count(SaveOutcome::CONVERTED) + result.count(SaveOutcome::REUSED) + result.count(SaveOutcome::RESUMED),
+            result.saves.size() - result.count(SaveOutcome::SKIPPED),
+            result.read || result.cancelled ? L"" : L", input could not be read",
+            result.cancelled ? L", cancelled" : L""
+    );
 
-    // Only print if the delay is >50ms, as writing to stdout slows
-    // down the conversion.
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(current_time - pep_last_time).count() < 50) {
-        return;
+    if (result.failed()) {
+        pg::eprintln(L"{}", fmt::styled(outcome, fmt::fg(fmt::color::red) | fmt::emphasis::bold));
     } else {
-        pep_last_time = current_time;
+        pg::println(L"{}", fmt::styled(outcome, fmt::fg(fmt::color::white)));
     }
+}
 
-    // Calculate the percentage of the extraction.
-    double percentage = static_cast<double>(current_size) / pep_extraction_size * 100.0;
-    percentage = std::clamp(percentage, 0.0, 100.0);
+int main(int argc, char* argv[]) {
+    // If on Windows, this must be executed to allow the output stream of stdout to receive UTF-16 characters.
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_U16TEXT);
+#endif
+    cxxopts::Options options("X360MSE", "Extract Xbox 360 Minecraft saves from a hard drive or compacted backup");
 
-    if (pep_prev_text_size != 0) {
-        // Erase the previous text, based on the size of the previous text.
-        fmt::print(L"{}", std::wstring(pep_prev_text_size, '\b'));
-    }
+    options.add_options()
+            ("i,input", "Input file or folder (can be HDD mounting point, eg. X:\\, or raw HDD image); can be repeated", cxxopts::value<std::vector<std::string>>())
+            ("o,output", "Output folder; for a manifest, the output folder of inputs listed without one", cxxopts::value<std::string>())
+            ("manifest", "File listing inputs, one per line, each optionally followed by a tab and its output folder", cxxopts::value<std::string>())
+            ("watch", "Drop folder to watch for inputs until interrupted, converting each into a folder of the output folder named after it", cxxopts::value<std::string>())
+            ("j,jobs", "Maximum number of saves converted at once (0 = automatic)", cxxopts::value<unsigned int>()->default_value("0"))
+            ("t,threads", "Total number of threads shared by all conversions (0 = all cores)", cxxopts::value<unsigned int>()->default_value("0"))
+            ("target", "Editions to convert saves to, separated by commas: java, bedrock", cxxopts::value<std::string>()->default_value("java"))
+            ("keep-bin", "Also write the save files extracted from archives to the output folder")
+            ("no-copy", "Convert save files found in folders where they are, rather than copying them to the output folder")
+            ("cache-dir", "Folder to keep converted worlds in, to reuse them for identical saves in later runs", cxxopts::value<std::string>())
+            ("output-format", "Format to write converted worlds in: folder, zip, 7z or tar; archived worlds are first written to the scratch folder, on disk unless it fits in memory", cxxopts::value<std::string>()->default_value("folder"))
+            ("spawn", "Spawn point to set in every converted world, as x,y,z", cxxopts::value<std::string>())
+            ("game-rule", "Game rule to set in every converted world, as name=value; can be repeated", cxxopts::value<std::vector<std::string>>())
+            ("dimensions", "Dimensions to convert, separated by commas: overworld, nether, end (default: all)", cxxopts::value<std::string>())
+            ("bbox", "Chunks to convert in each dimension, as the chunk coordinates x0,z0,x1,z1 of two opposite corners (default: all)", cxxopts::value<std::string>())
+            ("scratch-dir", "Folder to write intermediate files to when they do not fit in memory (default: system temporary folder)", cxxopts::value<std::string>())
+            ("scratch-memory", "Memory in MiB intermediate files may take on a RAM-backed file system (default: half of it, 0 = never)", cxxopts::value<uintmax_t>())
+            ("resume", "Resume an interrupted run into the same output folder, skipping the saves it finished")
+            ("max-memory", "Memory in MiB running conversions, saves held in memory and in-memory scratch folders may take in total, as estimated from the saves and measured conversions (default: no limit)", cxxopts::value<uint64_t>())
+            ("max-nesting", "Number of archives an archive may be nested in to be searched for saves (0 = only the input)", cxxopts::value<unsigned int>()->default_value("3"))
+            ("max-nested-size", "Size in MiB of the largest nested archive searched for saves, as it is held in memory", cxxopts::value<uint64_t>()->default_value("4096"))
+            ("metrics-out", "File to write a JSON report of the time and bytes spent in each stage to", cxxopts::value<std::string>())
+            ("list", "List the saves in the input archive as JSON, without extracting or converting anything")
+            ("q,quiet", "Only print errors")
+            ("h,help", "Print usage");
 
-    auto text = fmt::format(
-            L"{} {} {}",
-            fmt::styled(uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, fmt::fg(fmt::color::white)),
-            fmt::styled(fmt::format(L"[{:.2f}%]", percentage), fmt::fg(fmt::color::green_yellow)),
-            fmt::styled(L"Extracting...", fmt::fg(fmt::color::white))
-    );
+    auto result = options.parse(argc, argv);
 
-    // Store the size of the text to erase it later.
-    pep_prev_text_size = text.size();
+    const auto list = result.count("list") > 0;
 
-    fmt::print(L"{}", text);
-}
+    const auto watch_directory = result.count("watch") && !list ?
+            std::make_optional<std::filesystem::path>(result["watch"].as<std::string>()) :
+            std::nullopt;
 
-/**
- * Extracts the specified item from the archive.
- *
- * @param extractor the extractor to use.
- * @param archive_path the path to the archive. Note that this is the path to the archive itself,
- *                     <b>NOT</b> the path of the item inside the archive!
- * @param output_directory the directory to extract the item to.
- * @param info the information of the item to extract.
- */
-void extract_from_archive(
-        bit7z::BitFileExtractor &extractor,
-        const std::filesystem::path &archive_path,
-        const std::filesystem::path &output_directory,
-        const bit7z::BitArchiveItemInfo &info,
-        const std::optional<je2be::xbox360::MinecraftSaveInfo::SaveBin>& bin = std::nullopt
-        ) {
-    const auto output_path =
-            bin.has_value() ?
-                unique_path(output_directory, fmt::format(L"{} ({}).bin", x360mse::util::to_wstring(bin->fTitle), regex_replace(info.name(), std::wregex(L"\\.bin$"), L""))):
-                unique_path(output_directory, info.name());
-
-    auto output_stream = std::ofstream { output_path, std::ios::binary };
-
-    // Set the total callback function for the extraction.
-    // This function is called with the total size of the file after extraction.
-    extractor.setTotalCallback(set_total_size);
-
-    // Set the progress callback function for the extraction.
-    // This function is called with the current size of the file during extraction.
-    extractor.setProgressCallback([&](uint64_t current_size) -> bool {
-        print_extraction_progress(current_size);
-        return true; // Continue the operation.
-    });
-
-    // Extract the item from the archive.
-    extractor.extract(archive_path, output_stream, info.index());
+    const auto has_input = result.count("input") > 0 || result.count("manifest") > 0 || watch_directory;
+    const auto has_output = result.count("output") > 0 || (result.count("manifest") > 0 && !watch_directory) || list;
 
-    try {
-#ifdef _WIN32
-        HANDLE file_handle = CreateFileW(output_path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
-                                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (result.count("help") || !has_input || !has_output) {
+        pg::println(L"{}", x360mse::util::to_wstring(options.help()));
 
-        if (file_handle == INVALID_HANDLE_VALUE) {
-            return;
-        }
+        return EXIT_SUCCESS;
+    }
+
+    // Render logs and progress from a dedicated thread. Progress is only
+    // drawn on terminals, as redrawing lines makes no sense in a log file.
+    // Only errors are printed when listing, so the listing can be piped.
+    pg::renderer().start(
+            result.count("quiet") || list ? pg::Mode::QUIET :
+            pg::is_terminal() ? pg::Mode::INTERACTIVE :
+            pg::Mode::PLAIN
+    );
 
-        FILETIME creation_time;
-        FILETIME last_access_time;
-        FILETIME last_write_time;
+    // Write the remaining logs and show the cursor again when exiting.
+    defer {
+        pg::renderer().stop();
+    };
 
-        auto convert_to_filetime = [](const std::chrono::system_clock::time_point& tp) -> FILETIME {
-            // Convert time_point to cast_time to use Windows epoch.
-            auto cast_time = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count() / 100;  // Convert to 100-nanoseconds units.
+    pg::println(L"");
+    pg::println(L"{}", fmt::styled(fmt::format(L"{} {}", uc::RIGHTWARDS_HEAVY_ARROW, L"Welcome to Xbox 360 Minecraft Save Extractor! (X360MSE)"), fmt::fg(fmt::color::white)));
+    pg::println(L"");
+
+    // List the saves in the input archive from its headers, if requested, and stop there.
+    if (list) {
+        if (result.count("manifest") || result["input"].as<std::vector<std::string>>().size() != 1) {
+            pg::eprintln(
+                    L"{}",
+                    fmt::styled(
+                            std::format(L"{} {}", uc::X, L"[Error] Only a single input can be listed!"),
+                            fmt::fg(fmt::color::red) | fmt::emphasis::bold
+                    ));
 
-            // Adjust for the difference between UNIX epoch and Windows epoch.
-            // Windows epoch starts 11644473600 seconds before UNIX epoch.
-            const auto WINDOWS_TICKS = 116444736000000000LL;
-            cast_time += WINDOWS_TICKS;
+            return EXIT_FAILURE;
+        }
 
-            FILETIME file_time;
-            file_time.dwLowDateTime = static_cast<DWORD>(cast_time);
-            file_time.dwHighDateTime = static_cast<DWORD>(cast_time >> 32);
+        const auto input_path = std::filesystem::path(result["input"].as<std::vector<std::string>>().front());
 
-            return file_time;
-        };
+        try {
+            const auto saves = x360mse::converter::list_archive(input_path);
 
-        creation_time = convert_to_filetime(info.creationTime());
-        last_access_time = convert_to_filetime(info.lastAccessTime());
-        last_write_time = convert_to_filetime(info.lastWriteTime());
+            // Write the listing once every error was printed.
+            pg::renderer().stop();
 
-        if (!SetFileTime(file_handle, &creation_time, &last_access_time, &last_write_time)) {
-            fmt::println(
+            fmt::print(L"{}", x360mse::util::to_wstring(x360mse::inventory::to_json(input_path, saves)));
+        } catch (const std::invalid_argument&) {
+            pg::eprintln(
                     L"{}",
                     fmt::styled(
-                            std::format(L"{} {}:\n{}", uc::X, L"[Error] Failed to set file times!", x360mse::util::to_wstring(std::to_string(GetLastError()))),
+                            std::format(L"{} {}", uc::X, L"[Error] Only archives can be listed!"),
                             fmt::fg(fmt::color::red) | fmt::emphasis::bold
                     ));
-        }
-
-        CloseHandle(file_handle);
-#endif
-    } catch (std::exception& ex) {
-        fmt::println(
-                L"{}",
-                fmt::styled(
-                        std::format(L"{} {}:\n{}", uc::X, L"[Error] An exception has occurred!", x360mse::util::to_wstring(std::string(ex.what()))),
-                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                ));
-    }
-}
 
-/**
- * Extracts all items from the specified archive.
- *
- * @param archive_path the path to the archive.
- * @param output_directory the directory to extract the items to.
- * @param lib7z the bit7z instance.
- * @param save_file_pattern the pattern to match save files.
- * @param file_index the index of the file in the total.
- * @param file_total the total number of files to extract.
- */
-void extract_all_from_archive(
-        const std::filesystem::path& archive_path,
-        const std::filesystem::path& output_directory,
-        const bit7z::Bit7zLibrary& lib7z,
-        const std::wregex& minecraft_save_info_pattern,
-        const std::wregex& save_file_pattern,
-        size_t file_index,
-        size_t file_total,
-        std::map<std::wstring, je2be::xbox360::MinecraftSaveInfo::SaveBin>& save_bins
-        ) {
-    fmt::println(L"{}",
-               fmt::format(
-                       L"{} {}",
-                       fmt::styled(fmt::format(L"{} [{} / {}] ", uc::RIGHTWARDS_HEAVY_ARROW, file_index + 1, file_total),fmt::fg(fmt::color::cyan)),
-                       fmt::styled(fmt::format(L"Processing {}...", archive_path.filename().wstring()),fmt::fg(fmt::color::white))
-               ));
-
-    fmt::print(L"\n");
-
-    // Hide the cursor to avoid flickering.
-    fmt::print(L"\033[?25l");
+            return EXIT_FAILURE;
+        } catch (const std::exception& ex) {
+            pg::eprintln(
+                    L"{}",
+                    fmt::styled(
+                            std::format(L"{} {}:\n{}", uc::X, L"[Error] An exception has occurred!", x360mse::util::to_wstring(std::string(ex.what()))),
+                            fmt::fg(fmt::color::red) | fmt::emphasis::bold
+                    ));
 
-    try {
-        auto extractor = bit7z::BitFileExtractor {  lib7z };
-        const auto reader = bit7z::BitArchiveReader {lib7z, archive_path.wstring() };
+            return EXIT_FAILURE;
+        }
 
-        std::vector<bit7z::BitArchiveItemInfo> filtered_infos;
+        return EXIT_SUCCESS;
+    }
 
-        size_t filtered_info_total = 0;
+    const auto default_output_directory = result.count("output") ?
+            std::make_optional<std::filesystem::path>(result["output"].as<std::string>()) :
+            std::nullopt;
 
-        // Find and store the items in the archive matching save files.
-        for (const auto& info : reader.items()) {
-            if (std::regex_match(info.name(), save_file_pattern)) {
-                filtered_infos.push_back(info);
-                filtered_info_total += 1;
-            }
+    // Collect the inputs given on the command line, then the ones listed in the manifest.
+    std::vector<x360mse::batch::Input> inputs;
 
-            if (std::regex_match(info.name(), minecraft_save_info_pattern)) {
-                std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+    if (result.count("input")) {
+        if (!default_output_directory) {
+            pg::eprintln(
+                    L"{}",
+                    fmt::styled(
+                            std::format(L"{} {}", uc::X, L"[Error] Inputs given with --input need an output folder given with --output!"),
+                            fmt::fg(fmt::color::red) | fmt::emphasis::bold
+                    ));
 
-                // Extract this file to a temporary directory.
-                // Then, parse the MinecraftSaveInfo file.
-                // Afterward, delete the temporary file.
-                const auto temp_output_directory = std::filesystem::temp_directory_path() / info.name();
-                std::filesystem::create_directories(temp_output_directory);
+            return EXIT_FAILURE;
+        }
 
-                extract_from_archive(extractor, archive_path, temp_output_directory, info);
+        for (const auto& input : result["input"].as<std::vector<std::string>>()) {
+            inputs.push_back({ input, *default_output_directory });
+        }
+    }
 
-                je2be::xbox360::MinecraftSaveInfo::Parse(temp_output_directory / info.name(), bins);
+    if (result.count("manifest")) {
+        try {
+            const auto listed_inputs = x360mse::batch::parse_manifest(result["manifest"].as<std::string>(), default_output_directory);
 
-                fmt::print(L"\n");
-                fmt::println(L"{}",
-                           fmt::format(
-                                   L"{} {}",
-                                   fmt::styled(fmt::format(L"{} [{} / {}]", uc::RIGHTWARDS_HEAVY_ARROW, file_index + 1, file_total), fmt::fg(fmt::color::green_yellow)),
-                                   fmt::styled(fmt::format(L"Found MinecraftSaveInfo file {} with following bins:", info.name()), fmt::fg(fmt::color::white))
-                           ));
-                fmt::print(L"\n");
+            inputs.insert(inputs.end(), listed_inputs.begin(), listed_inputs.end());
+        } catch (const std::exception& ex) {
+            pg::eprintln(
+                    L"{}",
+                    fmt::styled(
+                            std::format(L"{} {}:\n{}", uc::X, L"[Error] Invalid manifest", x360mse::util::to_wstring(std::string(ex.what()))),
+                            fmt::fg(fmt::color::red) | fmt::emphasis::bold
+                    ));
 
-                size_t bin_index = 0;
-                size_t bin_total = bins.size();
+            return EXIT_FAILURE;
+        }
+    }
 
-                for (const auto& bin : bins) {
-                    auto file_name = x360mse::util::to_wstring(bin.fFileName);
-                    auto title = x360mse::util::to_wstring(bin.fTitle);
+    if (inputs.empty() && !watch_directory) {
+        pg::eprintln(
+                L"{}",
+                fmt::styled(
+                        std::format(L"{} {}", uc::X, L"[Error] No input given!"),
+                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
+                ));
 
-                    file_name = std::regex_replace(file_name, std::wregex(L"^ +"), L"");
+        return EXIT_FAILURE;
+    }
 
-                    fmt::println(L"{}",
-                               fmt::format(
-                                       L"{} {}",
-                                       fmt::styled(fmt::format(L"{} [{} / {}]", uc::RIGHTWARDS_HEAVY_ARROW, bin_index + 1, bin_total), fmt::fg(fmt::color::light_pink)),
-                                       fmt::styled(fmt::format(L"{} {} {}", file_name, uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, title), fmt::fg(fmt::color::white))
-                               ));
+    const auto keep_bin = result.count("keep-bin") > 0;
+    const auto resume = result.count("resume") > 0;
+    const auto in_place = result.count("no-copy") > 0;
 
-                    save_bins[x360mse::util::to_wstring(bin.fFileName)] = bin;
+    const auto cache_directory = result.count("cache-dir") ?
+            std::make_optional<std::filesystem::path>(result["cache-dir"].as<std::string>()) :
+            std::nullopt;
 
-                    bin_index += 1;
-                }
+    const auto metrics_path = result.count("metrics-out") ?
+            std::make_optional<std::filesystem::path>(result["metrics-out"].as<std::string>()) :
+            std::nullopt;
 
-                fmt::print(L"\n");
-            }
-        }
+    const auto scratch_directory = result.count("scratch-dir") ?
+            std::make_optional<std::filesystem::path>(result["scratch-dir"].as<std::string>()) :
+            std::nullopt;
 
-        size_t filtered_info_index = 0;
+    const auto scratch_memory = result.count("scratch-memory") ?
+            std::make_optional<uintmax_t>(result["scratch-memory"].as<uintmax_t>() * 1024 * 1024) :
+            std::nullopt;
 
-        for (const auto& info : filtered_infos) {
-            // Extract the item from the archive and measure the time it takes.
-            const auto duration_ms = x360mse::util::run_measuring_ms([&]() {
-                extract_from_archive(extractor, archive_path, output_directory, info, save_bins.contains(info.name()) ? std::make_optional<>(save_bins[info.name()]) : std::nullopt);
-            });
+    const auto max_memory = result.count("max-memory") ?
+            std::make_optional<uint64_t>(result["max-memory"].as<uint64_t>() * 1024 * 1024) :
+            std::nullopt;
 
-            std::wcout << std::wstring(pep_prev_text_size, '\b');
+    const auto nesting = x360mse::nesting::NestingLimits {
+            result["max-nesting"].as<unsigned int>(),
+            result["max-nested-size"].as<uint64_t>() * 1024 * 1024,
+    };
 
-            fmt::println(L"{}",
-                       fmt::format(
-                               L"{} {} {}",
-                               fmt::styled(fmt::format(L"{} [{} / {}]", uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, filtered_info_index + 1, filtered_info_total), fmt::fg(fmt::color::green_yellow)),
-                               fmt::styled(fmt::format(L"Extracted {} to {}!", info.name(), output_directory.wstring()), fmt::fg(fmt::color::white)),
-                               fmt::styled(fmt::format(L"({}ms)", duration_ms), fmt::fg(fmt::color::green_yellow))
-                       ));
+    std::optional<x360mse::archive::OutputFormat> output_format;
 
-            filtered_info_index += 1;
-        }
-    } catch (std::exception& ex) {
-        fmt::println(
+    try {
+        output_format = x360mse::archive::parse_output_format(result["output-format"].as<std::string>());
+    } catch (const std::exception& ex) {
+        pg::eprintln(
                 L"{}",
                 fmt::styled(
-                        std::format(L"{} {}:\n{}", uc::X, L"[Error] An exception has occurred!", x360mse::util::to_wstring(std::string(ex.what()))),
+                        std::format(L"{} {}:\n{}", uc::X, L"[Error] Invalid output format", x360mse::util::to_wstring(std::string(ex.what()))),
                         fmt::fg(fmt::color::red) | fmt::emphasis::bold
                 ));
+
+        return EXIT_FAILURE;
     }
 
-    // Show the cursor again.
-    fmt::print(L"\033[?25h");
-}
-
-/**
- * Copies all save files from the specified directory to the output directory.
- *
- * @param directory_path the directory to copy files from.
- * @param output_directory the directory to copy files to.
- * @param save_file_pattern the pattern to match save files.
- * @param directory_index the index of the directory in the total.
- * @param directory_total the total number of directories to copy from.
- */
-void copy_all_from_directory(
-        const std::filesystem::path& directory_path,
-        const std::filesystem::path& output_directory,
-        const std::wregex& minecraft_save_info_pattern,
-        const std::wregex& save_file_pattern,
-        size_t directory_index,
-        size_t directory_total,
-        std::map<std::wstring, je2be::xbox360::MinecraftSaveInfo::SaveBin>& save_bins
-        ) {
-    fmt::println(L"{}",
-               fmt::format(
-                       L"{} {}",
-                       fmt::styled(fmt::format(L"{} [{} / {}] ", uc::RIGHTWARDS_HEAVY_ARROW, directory_index + 1, directory_total), fmt::fg(fmt::color::cyan)),
-                       fmt::styled(fmt::format(L"Processing {}...", directory_path.filename().wstring()),fmt::fg(fmt::color::white))
-               ));
-
-    fmt::print(L"\n");
+    std::vector<x360mse::edition::Edition> editions;
 
     try {
-        std::vector<std::filesystem::path> filtered_paths;
-
-        size_t filtered_path_total = 0;
-
-        // Find and store all save files in the directory.
-        for (const auto &entry: std::filesystem::directory_iterator(directory_path)) {
-            if (std::filesystem::is_regular_file(entry)) {
-                if (std::regex_match(entry.path().filename().wstring(), save_file_pattern)) {
-                    filtered_paths.push_back(entry.path());
-                    filtered_path_total += 1;
-                }
+        editions = x360mse::edition::parse_editions(result["target"].as<std::string>());
+    } catch (const std::exception& ex) {
+        pg::eprintln(
+                L"{}",
+                fmt::styled(
+                        std::format(L"{} {}:\n{}", uc::X, L"[Error] Invalid target", x360mse::util::to_wstring(std::string(ex.what()))),
+                        fmt::fg(fmt::color::red) | fmt::emphasis::bold
+                ));
 
-                if (std::regex_match(entry.path().filename().wstring(), minecraft_save_info_pattern)) {
-                    std::vector<je2be::xbox360::MinecraftSaveInfo::SaveBin> bins;
+        return EXIT_FAILURE;
+    }
 
-                    je2be::xbox360::MinecraftSaveInfo::Parse(entry.path(), bins);
+    // Collect the overrides applied to every converted world.
+    x360mse::level::LevelOverrides level_overrides;
 
-                    for (const auto& bin : bins) {
-                        save_bins[x360mse::util::to_wstring(bin.fFileName)] = bin;
-                    }
-                }
-            }
+    try {
+        if (result.count("spawn")) {
+            level_overrides.spawn = x360mse::level::LevelOverrides::parse_spawn(result["spawn"].as<std::string>());
         }
 
-        size_t filtered_path_index = 0;
-
-        for (const auto& path : filtered_paths) {
-            const auto output_path =
-                save_bins.contains(path.filename().wstring()) ?
-                    unique_path(output_directory, fmt::format(L"{} ({})", x360mse::util::to_wstring(save_bins[path.filename().wstring()].fFileName), path.filename().wstring())) :
-                    unique_path(output_directory, path.filename());
-
-            // Copy the file to the output directory and measure the time it takes.
-            const auto duration_ms = x360mse::util::run_measuring_ms([&]() {
-                std::filesystem::copy(path, output_path);
-            });
-
-            fmt::println(L"{}",
-                       fmt::format(
-                               L"{} {} {}",
-                               fmt::styled(fmt::format(L"{} [{} / {}]", uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, filtered_path_index + 1, filtered_path_total), fmt::fg(fmt::color::green_yellow)),
-                               fmt::styled(fmt::format(L"Copied {} to {}!", path.filename().wstring(), output_directory.wstring()), fmt::fg(fmt::color::white)),
-                               fmt::styled(fmt::format(L"({}ms)", duration_ms), fmt::fg(fmt::color::green_yellow))
-                       ));
-
-            filtered_path_index += 1;
+        if (result.count("game-rule")) {
+            for (const auto& game_rule : result["game-rule"].as<std::vector<std::string>>()) {
+                level_overrides.game_rules.insert(x360mse::level::LevelOverrides::parse_game_rule(game_rule));
+            }
         }
-    } catch (std::exception& ex) {
-        fmt::println(
+    } catch (const std::exception& ex) {
+        pg::eprintln(
                 L"{}",
                 fmt::styled(
-                        std::format(L"{} {}:\n{}", uc::X, L"[Error] An exception has occurred!", x360mse::util::to_wstring(std::string(ex.what()))),
+                        std::format(L"{} {}:\n{}", uc::X, L"[Error] Invalid level override", x360mse::util::to_wstring(std::string(ex.what()))),
                         fmt::fg(fmt::color::red) | fmt::emphasis::bold
                 ));
+
+        return EXIT_FAILURE;
     }
-}
 
-/**
- * Copies the specified file to the output directory.
- *
- * @param file_path the file to copy.
- * @param output_directory the directory to copy the file to.
- */
-void copy_file_(
-        const std::filesystem::path& file_path,
-        const std::filesystem::path& output_directory
-        ) {
-    try {
-        const auto output_path = unique_path(output_directory, file_path.filename());
+    // Collect the part of every world to convert.
+    x360mse::selection::Selection world_selection;
 
-        // Copy the file to the output directory and measure the time it takes.
-        const auto duration_ms = x360mse::util::run_measuring_ms([&]() {
-            std::filesystem::copy(file_path, output_path);
-        });
+    try {
+        if (result.count("dimensions")) {
+            world_selection.dimensions = x360mse::selection::Selection::parse_dimensions(result["dimensions"].as<std::string>());
+        }
 
-        fmt::println(L"{}",
-                   fmt::format(
-                           L"{} {} {}",
-                           fmt::styled(fmt::format(L"{} [{} / {}]", uc::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, 1, 1), fmt::fg(fmt::color::green_yellow)),
-                           fmt::styled(fmt::format(L"Copied {} to {}!", file_path.filename().wstring(), output_directory.wstring()), fmt::fg(fmt::color::white)),
-                           fmt::styled(fmt::format(L"({}ms)", duration_ms), fmt::fg(fmt::color::green_yellow))
-                   ));
-    } catch (std::exception& ex) {
-        fmt::println(
+        if (result.count("bbox")) {
+            world_selection.box = x360mse::selection::Selection::parse_box(result["bbox"].as<std::string>());
+        }
+    } catch (const std::exception& ex) {
+        pg::eprintln(
                 L"{}",
                 fmt::styled(
-                        std::format(L"{} {}:\n{}", uc::X, L"[Error] An exception has occurred!", x360mse::util::to_wstring(std::string(ex.what()))),
+                        std::format(L"{} {}:\n{}", uc::X, L"[Error] Invalid selection", x360mse::util::to_wstring(std::string(ex.what()))),
                         fmt::fg(fmt::color::red) | fmt::emphasis::bold
                 ));
+
+        return EXIT_FAILURE;
     }
-}
 
-int main(int argc, char* argv[]) {
-    // If on Windows, this must be executed to allow the output stream of stdout to receive UTF-16 characters.
-#ifdef _WIN32
-    _setmode(_fileno(stdout), _O_U16TEXT);
-#endif
-    cxxopts::Options options("X360MSE", "Extract Xbox 360 Minecraft saves from a hard drive or compacted backup");
+    if (watch_directory) {
+        pg::println(L"{}",
+                   fmt::format(
+                           L"{} {}: {}",
+                           fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                           fmt::styled(L"Watching for inputs in", fmt::fg(fmt::color::white)),
+                           fmt::styled( watch_directory->wstring(), fmt::fg(fmt::color::green_yellow))
+                   )
+        );
+
+        pg::println(L"{}",
+                   fmt::format(
+                           L"{} {}: {}",
+                           fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                           fmt::styled(L"Into", fmt::fg(fmt::color::white)),
+                           fmt::styled( default_output_directory->wstring(), fmt::fg(fmt::color::green_yellow))
+                   )
+        );
+
+        if (!inputs.empty()) {
+            pg::println(L"{}",
+                       fmt::format(
+                               L"{} {}",
+                               fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                               fmt::styled(fmt::format(L"Extracting save file(s) from {} input(s) first.", inputs.size()), fmt::fg(fmt::color::white))
+                       )
+            );
+        }
+    } else if (inputs.size() == 1) {
+        pg::println(L"{}",
+                   fmt::format(
+                           L"{} {}: {}",
+                           fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                           fmt::styled(L"Extracting save file(s) from", fmt::fg(fmt::color::white)),
+                           fmt::styled( inputs.front().path.wstring(), fmt::fg(fmt::color::green_yellow))
+                   )
+        );
+
+        pg::println(L"{}",
+                   fmt::format(
+                           L"{} {}: {}",
+                           fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                           fmt::styled(L"Into", fmt::fg(fmt::color::white)),
+                           fmt::styled( inputs.front().output_directory.wstring(), fmt::fg(fmt::color::green_yellow))
+                   )
+        );
+    } else {
+        pg::println(L"{}",
+                   fmt::format(
+                           L"{} {}",
+                           fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                           fmt::styled(fmt::format(L"Extracting save file(s) from {} inputs.", inputs.size()), fmt::fg(fmt::color::white))
+                   )
+        );
+    }
 
-    options.add_options()
-            ("i,input", "Input file or folder (can be HDD mounting point, eg. X:\\)", cxxopts::value<std::string>())
-            ("o,output", "Output folder", cxxopts::value<std::string>())
-            ("h,help", "Print usage");
+    pg::println(L"");
+
+
+    // Convert through the library, printing what it reports. The printer is
+    // declared before the converter, as events are reported until it is closed.
+    auto converter_options = x360mse::converter::ConverterOptions {
+            .thread_total = result["threads"].as<unsigned int>(),
+            .job_total = result["jobs"].as<unsigned int>(),
+            .editions = editions,
+            .output_format = output_format,
+            .overrides = level_overrides,
+            .selection = world_selection,
+            .nesting = nesting,
+            .keep_bin = keep_bin,
+            .in_place = in_place,
+            .resume = resume,
+            .cache_directory = cache_directory,
+            .scratch_directory = scratch_directory,
+            .scratch_memory = scratch_memory,
+            .max_memory = max_memory,
+            .report_progress = pg::renderer().progress_enabled(),
+    };
+
+    EventPrinter print_event;
+
+    const auto on_event = [&](const x360mse::events::Event& event) {
+        print_event(event);
+    };
 
-    auto result = options.parse(argc, argv);
+    try {
+        // Watch the drop folder before any thread starts, so failing to watch it ends the run cleanly.
+        std::optional<x360mse::watch::DropWatcher> watcher;
 
-    if (result.count("help") || !result.count("input") || !result.count("output")) {
-        fmt::println(L"{}", x360mse::util::to_wstring(options.help()));
+        if (watch_directory) {
+            watcher.emplace(*watch_directory);
+        }
 
-        return EXIT_SUCCESS;
-    }
+        x360mse::converter::Converter converter { std::move(converter_options) };
 
-    fmt::print(L"\n");
-    fmt::println(L"{}", fmt::styled(fmt::format(L"{} {}", uc::RIGHTWARDS_HEAVY_ARROW, L"Welcome to Xbox 360 Minecraft Save Extractor! (X360MSE)"), fmt::fg(fmt::color::white)));
-    fmt::print(L"\n");
+        std::atomic<bool> any_failed = false;
 
-    std::filesystem::path input_path = result["input"].as<std::string>();
-    std::filesystem::path output_directory = result["output"].as<std::string>();
+        // Keep the result of every input until the end of a batch, to report their outcomes;
+        // a watch runs until stopped, so inputs are reported as they finish instead.
+        std::vector<x360mse::converter::InputResult> results;
 
-    fmt::println(L"{}",
-               fmt::format(
-                       L"{} {}: {}",
-                       fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
-                       fmt::styled(L"Extracting save file(s) from", fmt::fg(fmt::color::white)),
-                       fmt::styled( input_path.wstring(), fmt::fg(fmt::color::green_yellow))
-               )
-    );
+        if (watcher) {
+            x360mse::watch::handle_stop_signals();
 
-    fmt::println(L"{}",
-               fmt::format(
-                       L"{} {}: {}",
-                       fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
-                       fmt::styled(L"Into", fmt::fg(fmt::color::white)),
-                       fmt::styled( output_directory.wstring(), fmt::fg(fmt::color::green_yellow))
-               )
-    );
+            const auto on_result = [&](const x360mse::converter::InputResult& input_result) {
+                if (input_result.failed()) {
+                    any_failed = true;
+                }
 
-    fmt::print(L"\n");
+                print_outcome(input_result);
+            };
 
-    const auto minecraft_save_info_pattern = std::wregex { LR"(_MinecraftSaveInfo)" };
-    const auto save_file_pattern = std::wregex {LR"(Save(.+)\.bin)"};
-    const auto compression_file_pattern = std::wregex { LR"(.+(7z|ar|arj|bzip2|cab|chm|cpio|cramfs|deb|dmg|ext|fat|gpt|gzip|hfs|hxs|ihex|iso|lzh|lzma|mbr|msi|nsis|ntfs|qcow2|rar|rar5|rpm|squashfs|tar|udf|uefi|vdi|vhd|vmdk|wim|xar|xz|z|zip))" };
+            // Convert the inputs given on the command line or in the manifest next to the ones dropped in.
+            for (const auto& input : inputs) {
+                converter.submit(input, on_event, on_result);
+            }
 
-    try {
-        bit7z::Bit7zLibrary lib7z{L"7z.dll"};
+            // Hand each entry landing in the drop folder to the converter, until stopped.
+            while (!x360mse::watch::stop_requested()) {
+                for (const auto& path : watcher->wait(std::chrono::milliseconds(500))) {
+                    pg::println(L"{}",
+                               fmt::format(
+                                       L"{} {}",
+                                       fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                                       fmt::styled(fmt::format(L"Received {}.", path.filename().wstring()), fmt::fg(fmt::color::white))
+                               ));
 
-        if (!std::filesystem::exists(output_directory)) {
-            // Create the output directory if it does not exist.
-            std::filesystem::create_directories(output_directory);
-        }
+                    converter.submit({ path, *default_output_directory / path.stem() }, on_event, on_result);
+                }
+            }
+
+            pg::println(L"");
+            pg::println(L"{}", fmt::styled(fmt::format(L"{} {}", uc::RIGHTWARDS_HEAVY_ARROW, L"Stopping; finishing the inputs received so far..."), fmt::fg(fmt::color::white)));
 
-        std::map<std::wstring, je2be::xbox360::MinecraftSaveInfo::SaveBin> save_bins;
-
-        if (std::filesystem::is_directory(input_path)) {
-            // If the input path is a directory, copy all save files from the directory to the output directory.
-            copy_all_from_directory(input_path, output_directory, minecraft_save_info_pattern, save_file_pattern, 0, 1, save_bins);
-        } else if (std::filesystem::is_regular_file(input_path) && std::regex_match(input_path.filename().wstring(), save_file_pattern)) {
-            // If the input path is a save file, copy the save file to the output directory.
-            copy_file_(input_path, output_directory);
-        } else if (std::filesystem::is_regular_file(input_path) && std::regex_match(input_path.filename().wstring(), compression_file_pattern)) {
-            // If the input path is a compressed archive, extract all save files from the archive to the output directory.
-            extract_all_from_archive(input_path, output_directory, lib7z, minecraft_save_info_pattern, save_file_pattern, 0, 1, save_bins);
+            converter.close();
         } else {
-            fmt::println(
-                    L"{}",
-                    fmt::styled(
-                            std::format(L"{} {}", uc::X, L"[Error] Input path is not a file or directory!"),
-                            fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                    ));
+            std::vector<x360mse::converter::Submission> submissions;
 
-            return EXIT_FAILURE;
-        }
+            for (const auto& input : inputs) {
+                submissions.push_back(converter.submit(input, on_event));
+            }
 
-        std::vector<std::filesystem::path> save_file_paths;
+            converter.close();
 
-        // Find and store all save files in the output directory.
-        for (const auto& entry : std::filesystem::directory_iterator(output_directory)) {
-            if (entry.path().extension() == ".bin") {
-                save_file_paths.push_back(entry.path());
+            for (const auto& submission : submissions) {
+                results.push_back(submission.result().get());
+
+                if (results.back().failed()) {
+                    any_failed = true;
+                }
             }
         }
 
-        size_t count = 0;
+        if (metrics_path) {
+            converter.metrics().write(*metrics_path);
 
-        for (const auto& save_path : save_file_paths) {
-            auto save_output_path = output_directory / save_path.stem();
+            pg::println(L"");
 
-            if (!std::filesystem::exists(save_output_path)) {
-                // Create the save's output directory if it does not exist.
-                std::filesystem::create_directories(save_output_path);
-            }
+            pg::println(L"{}",
+                       fmt::format(
+                               L"{} {}: {}",
+                               fmt::styled(uc::RIGHTWARDS_HEAVY_ARROW, fmt::fg(fmt::color::green_yellow)),
+                               fmt::styled(L"Wrote metrics to", fmt::fg(fmt::color::white)),
+                               fmt::styled(metrics_path->wstring(), fmt::fg(fmt::color::green_yellow))
+                       ));
+        }
 
-            // Convert the Minecraft Xbox 360 Edition save file to a Minecraft Java Edition save file.
-            const auto save_bin = std::ranges::find_if(save_bins, [&](const auto& bin) {
-                const auto trimmed_bin = bin.first.substr(0, bin.first.size() - 4);
-                return save_path.filename().wstring().find(trimmed_bin) != std::wstring::npos;
-            });
+        // Report the outcome of each input, so the failed ones can be run again on their own.
+        if (results.size() > 1) {
+            pg::println(L"");
 
-            if (save_bin != save_bins.end()) {
-                convert_file(save_path, save_output_path, count++, save_file_paths.size(), save_bin->second);
-            } else {
-                fmt::println(
-                        L"{}",
-                        fmt::styled(
-                                std::format(L"{} {}: {}", uc::X, L"[Error] Could not find save bin for file", save_path.wstring()),
-                                fmt::fg(fmt::color::red) | fmt::emphasis::bold
-                        ));
+            for (const auto& input_result : results) {
+                print_outcome(input_result);
             }
         }
+
+        if (any_failed) {
+            return EXIT_FAILURE;
+        }
     } catch (const std::exception& ex) {
-        fmt::println(
+        pg::eprintln(
                 L"{}",
                 fmt::styled(
                         std::format(L"{} {}:\n{}", uc::X, L"[Error] An exception has occurred!", x360mse::util::to_wstring(std::string(ex.what()))),
@@ -0,0 +1,343 @@
+#ifndef X360MSE_METRICS_H
+#define X360MSE_METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+// If on Windows, the working set is read through 'psapi.h'; elsewhere, the peak
+// resident set size is read through 'getrusage', and on Linux, the current one
+// through '/proc/self/statm'.
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "util.h"
+
+namespace x360mse::metrics {
+    /**
+     * A stage of the work done on the saves.
+     */
+    enum class Stage {
+        DISCOVERY,
+        EXTRACTION,
+        COPY,
+        PARSE_SAVE_INFO,
+        CONVERSION,
+        SET_LEVEL_NAME,
+        ARCHIVE,
+        BEDROCK_CONVERSION,
+    };
+
+    constexpr size_t STAGE_COUNT = 8;
+
+    /**
+     * @param stage the stage to name.
+     * @return the name of the stage in the report.
+     */
+    inline const char* to_string(Stage stage) {
+        switch (stage) {
+            case Stage::DISCOVERY: return "discovery";
+            case Stage::EXTRACTION: return "extraction";
+            case Stage::COPY: return "copy";
+            case Stage::PARSE_SAVE_INFO: return "parse_save_info";
+            case Stage::CONVERSION: return "conversion";
+            case Stage::SET_LEVEL_NAME: return "set_level_name";
+            case Stage::ARCHIVE: return "archive";
+            case Stage::BEDROCK_CONVERSION: return "bedrock_conversion";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * @return the peak resident memory of the process in bytes, or 0 if unknown.
+     */
+    inline uint64_t peak_rss_bytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.PeakWorkingSetSize;
+        }
+
+        return 0;
+#else
+        rusage usage {};
+
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+
+#ifdef __APPLE__
+        // Reported in bytes on macOS.
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        // Reported in kilobytes elsewhere.
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    /**
+     * @return the resident memory of the process in bytes, or 0 if unknown.
+     */
+    inline uint64_t current_rss_bytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.WorkingSetSize;
+        }
+
+        return 0;
+#elif defined(__linux__)
+        auto stream = std::ifstream { "/proc/self/statm" };
+
+        uint64_t total_pages = 0;
+        uint64_t resident_pages = 0;
+
+        if (!(stream >> total_pages >> resident_pages)) {
+            return 0;
+        }
+
+        return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif
+    }
+
+    namespace detail {
+        inline std::string escape_json(const std::string& text) {
+            std::string escaped;
+            escaped.reserve(text.size() + 2);
+
+            for (const auto character : text) {
+                switch (character) {
+                    case '"': escaped += "\\\""; break;
+                    case '\\': escaped += "\\\\"; break;
+                    case '\n': escaped += "\\n"; break;
+                    case '\r': escaped += "\\r"; break;
+                    case '\t': escaped += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(character) < 0x20) {
+                            escaped += fmt::format("\\u{:04x}", static_cast<unsigned char>(character));
+                        } else {
+                            escaped += character;
+                        }
+                }
+            }
+
+            return escaped;
+        }
+
+        inline double to_ms(std::chrono::nanoseconds duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        inline double to_mb_per_s(uint64_t bytes, std::chrono::nanoseconds duration) {
+            const auto seconds = std::chrono::duration<double>(duration).count();
+
+            return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+        }
+    }
+
+    /**
+     * The time spent in a stage and the bytes it processed.
+     */
+    struct StageSample {
+        std::chrono::nanoseconds duration { 0 };
+        uint64_t bytes = 0;
+        uint64_t count = 0;
+
+        void add(std::chrono::nanoseconds sample_duration, uint64_t sample_bytes) {
+            duration += sample_duration;
+            bytes += sample_bytes;
+            count += 1;
+        }
+    };
+
+    /**
+     * Collects the time and byte counts of every stage, per save and for the
+     * whole run, and writes them as a JSON report.
+     *
+     * Stages not tied to a single save, such as discovering the saves of a
+     * folder or parsing a '_MinecraftSaveInfo' file, only count toward the
+     * run-wide totals. Recording is thread-safe.
+     */
+    class MetricsReport {
+    public:
+        MetricsReport() = default;
+
+        /**
+         * Registers a save, so stages recorded for it are reported under its name.
+         *
+         * @param save_id the identifier of the save; see {@code SaveSource::id}.
+         * @param name the name of the save file.
+         * @param size the size of the save file in bytes.
+         */
+        void add_save(uint64_t save_id, const std::wstring& name, uintmax_t size) {
+            std::lock_guard lock(mutex_);
+
+            auto& save = saves_[save_id];
+            save.name = x360mse::util::to_utf8(name);
+            save.size = size;
+        }
+
+        /**
+         * Records a stage done for a single save.
+         *
+         * @param save_id the identifier of the save.
+         * @param stage the stage.
+         * @param duration the time spent in the stage.
+         * @param bytes the bytes processed by the stage.
+         */
+        void record(uint64_t save_id, Stage stage, std::chrono::nanoseconds duration, uint64_t bytes) {
+            std::lock_guard lock(mutex_);
+
+            saves_[save_id].stages[static_cast<size_t>(stage)].add(duration, bytes);
+            totals_[static_cast<size_t>(stage)].add(duration, bytes);
+        }
+
+        /**
+         * Records the memory a save took while it was converted.
+         *
+         * @param save_id the identifier of the save.
+         * @param bytes the peak memory of the conversion in bytes.
+         */
+        void record_memory(uint64_t save_id, uint64_t bytes) {
+            std::lock_guard lock(mutex_);
+
+            auto& save = saves_[save_id];
+            save.peak_memory_bytes = std::max(save.peak_memory_bytes, bytes);
+        }
+
+        /**
+         * Records a stage not tied to a single save.
+         *
+         * @param stage the stage.
+         * @param duration the time spent in the stage.
+         * @param bytes the bytes processed by the stage.
+         */
+        void record(Stage stage, std::chrono::nanoseconds duration, uint64_t bytes) {
+            std::lock_guard lock(mutex_);
+
+            totals_[static_cast<size_t>(stage)].add(duration, bytes);
+        }
+
+        /**
+         * Writes the report as JSON.
+         *
+         * Throughput is computed over the wall-clock time since the report was
+         * created for the run, and over the time spent in each stage otherwise.
+         *
+         * @param path the file to write the report to.
+         */
+        void write(const std::filesystem::path& path) const {
+            std::lock_guard lock(mutex_);
+
+            const auto wall_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time_);
+
+            uint64_t input_bytes = 0;
+
+            for (const auto& [save_id, save] : saves_) {
+                input_bytes += save.size;
+            }
+
+            std::string json;
+
+            json += "{\n";
+            json += fmt::format("  \"duration_ms\": {:.3f},\n", detail::to_ms(wall_duration));
+            json += fmt::format("  \"peak_rss_bytes\": {},\n", peak_rss_bytes());
+            json += fmt::format("  \"save_count\": {},\n", saves_.size());
+            json += fmt::format("  \"input_bytes\": {},\n", input_bytes);
+            json += fmt::format("  \"throughput_mb_s\": {:.3f},\n", detail::to_mb_per_s(input_bytes, wall_duration));
+            json += "  \"totals\": " + write_stages(totals_, "  ") + ",\n";
+            json += "  \"saves\": [";
+
+            bool first_save = true;
+
+            for (const auto& [save_id, save] : saves_) {
+                json += first_save ? "\n" : ",\n";
+                json += "    {\n";
+                json += fmt::format("      \"name\": \"{}\",\n", detail::escape_json(save.name));
+                json += fmt::format("      \"size\": {},\n", save.size);
+                json += fmt::format("      \"peak_memory_bytes\": {},\n", save.peak_memory_bytes);
+                json += "      \"stages\": " + write_stages(save.stages, "      ") + "\n";
+                json += "    }";
+
+                first_save = false;
+            }
+
+            json += first_save ? "]\n" : "\n  ]\n";
+            json += "}\n";
+
+            auto stream = std::ofstream { path, std::ios::binary };
+            stream.write(json.data(), static_cast<std::streamsize>(json.size()));
+
+            if (!stream) {
+                throw std::runtime_error("Failed to write metrics report");
+            }
+        }
+
+    private:
+        using Stages = std::array<StageSample, STAGE_COUNT>;
+
+        struct Save {
+            std::string name;
+            uintmax_t size = 0;
+            uint64_t peak_memory_bytes = 0;
+            Stages stages;
+        };
+
+        static std::string write_stages(const Stages& stages, const std::string& indent) {
+            std::string json = "{";
+            bool first = true;
+
+            for (size_t stage = 0; stage < STAGE_COUNT; stage++) {
+                const auto& sample = stages[stage];
+
+                if (sample.count == 0) {
+                    continue;
+                }
+
+                json += first ? "\n" : ",\n";
+                json += fmt::format(
+                        "{}  \"{}\": {{ \"count\": {}, \"duration_ms\": {:.3f}, \"bytes\": {}, \"throughput_mb_s\": {:.3f} }}",
+                        indent,
+                        to_string(static_cast<Stage>(stage)),
+                        sample.count,
+                        detail::to_ms(sample.duration),
+                        sample.bytes,
+                        detail::to_mb_per_s(sample.bytes, sample.duration)
+                );
+
+                first = false;
+            }
+
+            json += first ? "}" : "\n" + indent + "}";
+
+            return json;
+        }
+
+        mutable std::mutex mutex_;
+        std::chrono::steady_clock::time_point start_time_ = std::chrono::steady_clock::now();
+        Stages totals_;
+        std::map<uint64_t, Save> saves_;
+    };
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef X360MSE_NESTING_H
+#define X360MSE_NESTING_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cwctype>
+#include <string>
+
+namespace x360mse::nesting {
+    /**
+     * How deep, and how large, archives nested inside archives may be to be opened.
+     *
+     * Nested archives are extracted into memory before they are opened, so
+     * their size is bounded to bound the memory they take.
+     */
+    struct NestingLimits {
+        /**
+         * The number of archives an archive may be nested in; zero only opens the input itself.
+         * Compressed tarballs count twice, as their tarball is nested in the compressed stream.
+         */
+        unsigned int max_depth = 3;
+
+        /**
+         * The largest nested archive opened, in bytes.
+         */
+        uint64_t max_size = 4096ull * 1024 * 1024;
+    };
+
+    /**
+     * Tells whether an archive item may be an archive itself, from its name only.
+     *
+     * Items are only extracted to be identified from their contents once
+     * their name suggests an archive, so saves and other files are never
+     * decoded for nothing.
+     *
+     * @param name the name of the item.
+     * @return whether the name ends with the extension of an archive format.
+     */
+    inline bool is_archive_name(const std::wstring& name) {
+        static constexpr std::array<std::wstring_view, 13> EXTENSIONS = {
+                L".7z", L".zip", L".rar", L".tar", L".tgz", L".gz", L".bz2",
+                L".tbz2", L".xz", L".txz", L".cab", L".wim", L".iso",
+        };
+
+        std::wstring lowered = name;
+
+        std::ranges::transform(lowered, lowered.begin(), [](wchar_t character) {
+            return character < 0x80 ? static_cast<wchar_t>(std::towlower(character)) : character;
+        });
+
+        return std::ranges::any_of(EXTENSIONS, [&](std::wstring_view extension) {
+            return lowered.size() > extension.size() && lowered.ends_with(extension);
+        });
+    }
+}
+
+#endif
@@ -0,0 +1,429 @@
+#ifndef X360MSE_PROGRESS_H
+#define X360MSE_PROGRESS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <fmt/xchar.h>
+
+// If on Windows, '_isatty' lives in 'io.h'; elsewhere, 'isatty' lives in 'unistd.h'.
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "unicode.hpp"
+
+namespace x360mse::progress {
+    /**
+     * How the renderer writes to the console.
+     */
+    enum class Mode {
+        // Logs are printed, and active jobs are drawn below them and redrawn in place.
+        INTERACTIVE,
+        // Logs are printed as is; progress is not reported at all.
+        PLAIN,
+        // Only errors are printed; progress is not reported at all.
+        QUIET,
+    };
+
+    /**
+     * The state of an active job, shared between the job and the renderer.
+     */
+    struct JobState {
+        std::wstring label;
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+        // The completed fraction of the job, or a negative value if unknown.
+        std::atomic<double> fraction = -1.0;
+
+        // The fraction updated by the job itself, drawn instead of the one above if set.
+        std::shared_ptr<const std::atomic<double>> progress;
+
+        /**
+         * @return the completed fraction of the job, or a negative value if unknown.
+         */
+        [[nodiscard]] double load_fraction() const {
+            return (progress ? *progress : fraction).load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * A handle to report the progress of a job through.
+     *
+     * Reporting progress is a single atomic store, and does nothing if
+     * progress is not reported; the job is ended when the handle is destroyed.
+     */
+    class Job {
+    public:
+        Job() = default;
+
+        Job(std::shared_ptr<JobState> state, std::function<void(std::shared_ptr<JobState>)> on_end)
+                : state_(std::move(state)), on_end_(std::move(on_end)) {
+        }
+
+        Job(const Job&) = delete;
+        Job& operator=(const Job&) = delete;
+
+        Job(Job&& other) noexcept
+                : state_(std::move(other.state_)), on_end_(std::move(other.on_end_)) {
+        }
+
+        Job& operator=(Job&& other) noexcept {
+            end();
+
+            state_ = std::move(other.state_);
+            on_end_ = std::move(other.on_end_);
+
+            return *this;
+        }
+
+        ~Job() {
+            end();
+        }
+
+        /**
+         * Reports the completed fraction of the job.
+         *
+         * @param fraction the completed fraction, between 0 and 1.
+         */
+        void update(double fraction) const {
+            if (state_) {
+                state_->fraction.store(std::clamp(fraction, 0.0, 1.0), std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Ends the job, removing it from the active jobs.
+         */
+        void end() {
+            if (state_ && on_end_) {
+                on_end_(std::move(state_));
+            }
+
+            state_.reset();
+        }
+
+    private:
+        std::shared_ptr<JobState> state_;
+        std::function<void(std::shared_ptr<JobState>)> on_end_;
+    };
+
+    /**
+     * Writes logs and the progress of active jobs to the console from a
+     * dedicated thread.
+     *
+     * Other threads hand events to the renderer through a lock-free queue,
+     * so they never wait on console I/O. The renderer draws every active job
+     * on its own line below the logs, and redraws them in place about every
+     * 50ms, as writing to the console more often slows down the work.
+     *
+     * Events handed over while the renderer stops are still written, after
+     * its last render rather than interleaved with it.
+     */
+    class Renderer {
+    public:
+        Renderer() = default;
+
+        Renderer(const Renderer&) = delete;
+        Renderer& operator=(const Renderer&) = delete;
+
+        ~Renderer() {
+            stop();
+        }
+
+        /**
+         * Starts rendering on a dedicated thread.
+         *
+         * Until started, and after stopped, events are written synchronously.
+         *
+         * @param mode how to write to the console.
+         */
+        void start(Mode mode) {
+            mode_ = mode;
+
+            if (running_.exchange(true)) {
+                return;
+            }
+
+            if (mode_ == Mode::INTERACTIVE) {
+                // Hide the cursor to avoid flickering.
+                write(L"\033[?25l");
+            }
+
+            thread_ = std::thread([this]() { render_loop(); });
+        }
+
+        /**
+         * Stops rendering, writing every pending event first.
+         */
+        void stop() {
+            // Held until the last render, so events written synchronously wait for it.
+            std::lock_guard lock(stop_mutex_);
+
+            if (!running_.exchange(false)) {
+                return;
+            }
+
+            thread_.join();
+
+            // Events may have been pushed while the thread was finishing.
+            render();
+            erase_jobs();
+
+            if (mode_ == Mode::INTERACTIVE) {
+                // Show the cursor again.
+                write(L"\033[?25h");
+            }
+        }
+
+        /**
+         * @return whether progress is reported; when it is not, jobs cost nothing to report.
+         */
+        [[nodiscard]] bool progress_enabled() const {
+            return mode_ == Mode::INTERACTIVE;
+        }
+
+        /**
+         * Logs a line.
+         *
+         * @param text the line to log, without a trailing newline.
+         * @param error whether the line reports an error; only errors are logged in quiet mode.
+         */
+        void log(std::wstring text, bool error = false) {
+            if (mode_ == Mode::QUIET && !error) {
+                return;
+            }
+
+            if (!running_) {
+                std::lock_guard lock(stop_mutex_);
+
+                write(text + L"\n");
+                return;
+            }
+
+            push(new Event { error ? Event::Type::ERROR_LOG : Event::Type::LOG, std::move(text), nullptr, nullptr });
+            drain_if_stopped();
+        }
+
+        /**
+         * Starts a job, drawn until the returned handle is destroyed.
+         *
+         * @param label the text to draw next to the progress of the job.
+         * @param progress the completed fraction, if the job updates it itself; read on every render rather than reported through the handle.
+         * @return the handle to report the progress of the job through.
+         */
+        Job begin_job(std::wstring label, std::shared_ptr<const std::atomic<double>> progress = nullptr) {
+            if (!progress_enabled() || !running_) {
+                return {};
+            }
+
+            auto state = std::make_shared<JobState>();
+            state->label = std::move(label);
+            state->progress = std::move(progress);
+
+            push(new Event { Event::Type::BEGIN, {}, state, nullptr });
+            drain_if_stopped();
+
+            return { std::move(state), [this](std::shared_ptr<JobState> ended_state) {
+                if (running_) {
+                    push(new Event { Event::Type::END, {}, std::move(ended_state), nullptr });
+                    drain_if_stopped();
+                }
+            } };
+        }
+
+    private:
+        struct Event {
+            enum class Type {
+                LOG,
+                ERROR_LOG,
+                BEGIN,
+                END,
+            };
+
+            Type type;
+            std::wstring text;
+            std::shared_ptr<JobState> job;
+            Event* next;
+        };
+
+        void push(Event* event) {
+            // Push onto a lock-free stack; the renderer takes the whole stack at once.
+            event->next = head_.load(std::memory_order_relaxed);
+
+            while (!head_.compare_exchange_weak(event->next, event, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+
+        /**
+         * Writes the events pushed while the renderer was stopping, as they missed its last render.
+         *
+         * An event pushed before the renderer stopped is either taken by its last render, or
+         * seen here, as the stack is pushed to before checking whether the renderer still runs.
+         */
+        void drain_if_stopped() {
+            // Order the push before reading whether the renderer runs.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (running_) {
+                return;
+            }
+
+            std::lock_guard lock(stop_mutex_);
+
+            // Jobs are no longer drawn once stopped.
+            render();
+            erase_jobs();
+        }
+
+        std::vector<std::unique_ptr<Event>> take_all() {
+            std::vector<std::unique_ptr<Event>> events;
+
+            for (auto event = head_.exchange(nullptr, std::memory_order_acquire); event; event = event->next) {
+                events.emplace_back(event);
+            }
+
+            // The stack holds the most recent event first.
+            std::ranges::reverse(events);
+
+            return events;
+        }
+
+        void render_loop() {
+            while (running_) {
+                render();
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+
+        void render() {
+            const auto events = take_all();
+
+            std::wstring text;
+
+            if (mode_ == Mode::INTERACTIVE && drawn_lines_ > 0) {
+                // Move back to the first job line and clear everything below it.
+                text += fmt::format(L"\033[{}F\033[J", drawn_lines_);
+                drawn_lines_ = 0;
+            }
+
+            for (const auto& event : events) {
+                switch (event->type) {
+                    case Event::Type::LOG:
+                    case Event::Type::ERROR_LOG:
+                        text += event->text;
+                        text += L"\n";
+                        break;
+                    case Event::Type::BEGIN:
+                        jobs_.push_back(event->job);
+                        break;
+                    case Event::Type::END:
+                        std::erase(jobs_, event->job);
+                        break;
+                }
+            }
+
+            if (mode_ == Mode::INTERACTIVE) {
+                const auto now = std::chrono::steady_clock::now();
+
+                for (const auto& job : jobs_) {
+                    const auto fraction = job->load_fraction();
+
+                    const auto status = fraction >= 0.0 ?
+                            fmt::format(L"[{:.2f}%]", fraction * 100.0) :
+                            fmt::format(L"[{}s]", std::chrono::duration_cast<std::chrono::seconds>(now - job->start_time).count());
+
+                    text += fmt::format(
+                            L"{} {} {}\n",
+                            fmt::styled(unicode::RIGHT_SHADED_WHITE_RIGHTWARDS_ARROW, fmt::fg(fmt::color::white)),
+                            fmt::styled(status, fmt::fg(fmt::color::green_yellow)),
+                            fmt::styled(job->label, fmt::fg(fmt::color::white))
+                    );
+                }
+
+                drawn_lines_ = jobs_.size();
+            }
+
+            if (!text.empty()) {
+                write(text);
+            }
+        }
+
+        void erase_jobs() {
+            if (mode_ == Mode::INTERACTIVE && drawn_lines_ > 0) {
+                write(fmt::format(L"\033[{}F\033[J", drawn_lines_));
+                drawn_lines_ = 0;
+            }
+
+            jobs_.clear();
+        }
+
+        static void write(const std::wstring& text) {
+            fmt::print(L"{}", text);
+            std::fflush(stdout);
+        }
+
+        std::atomic<Event*> head_ = nullptr;
+        std::atomic<bool> running_ = false;
+        Mode mode_ = Mode::PLAIN;
+        std::thread thread_;
+        std::mutex stop_mutex_;
+
+        // Only accessed by the rendering thread, or under the stop mutex once it was joined.
+        std::vector<std::shared_ptr<JobState>> jobs_;
+        size_t drawn_lines_ = 0;
+    };
+
+    /**
+     * @return the renderer shared by the whole program.
+     */
+    inline Renderer& renderer() {
+        static Renderer instance;
+
+        return instance;
+    }
+
+    /**
+     * @return whether the standard output is a terminal.
+     */
+    inline bool is_terminal() {
+#ifdef _WIN32
+        return _isatty(_fileno(stdout)) != 0;
+#else
+        return isatty(fileno(stdout)) != 0;
+#endif
+    }
+
+    /**
+     * Formats and logs a line through the renderer.
+     */
+    template<typename... T>
+    void println(fmt::wformat_string<T...> format, T&&... args) {
+        renderer().log(fmt::format(format, std::forward<T>(args)...));
+    }
+
+    /**
+     * Formats and logs a line reporting an error through the renderer.
+     */
+    template<typename... T>
+    void eprintln(fmt::wformat_string<T...> format, T&&... args) {
+        renderer().log(fmt::format(format, std::forward<T>(args)...), true);
+    }
+}
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef X360MSE_SAVE_SOURCE_H
+#define X360MSE_SAVE_SOURCE_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hash.h"
+
+// If on Linux, anonymous memory files are used to hand buffers to the converter.
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace x360mse::source {
+    /**
+     * A save file handed to the converter through a path.
+     *
+     * Keeps the path valid for as long as it exists; if the save was
+     * held in memory, the backing file is released on destruction, along
+     * with the folder of its own it was written to.
+     */
+    class MaterializedSave {
+    public:
+        MaterializedSave(std::filesystem::path path, int descriptor, bool temporary)
+                : path_(std::move(path)), descriptor_(descriptor), temporary_(temporary) {
+        }
+
+        MaterializedSave(const MaterializedSave&) = delete;
+        MaterializedSave& operator=(const MaterializedSave&) = delete;
+
+        MaterializedSave(MaterializedSave&& other) noexcept
+                : path_(std::move(other.path_)),
+                  descriptor_(std::exchange(other.descriptor_, -1)),
+                  temporary_(std::exchange(other.temporary_, false)) {
+        }
+
+        ~MaterializedSave() {
+#ifdef __linux__
+            if (descriptor_ >= 0) {
+                close(descriptor_);
+            }
+#endif
+
+            if (temporary_) {
+                std::error_code error;
+                std::filesystem::remove_all(path_.parent_path(), error);
+            }
+        }
+
+        /**
+         * @return the path the converter can read the save from.
+         */
+        [[nodiscard]] const std::filesystem::path& path() const {
+            return path_;
+        }
+
+        /**
+         * @return whether the save was copied into an anonymous memory file, which the resident size of the process does not show.
+         */
+        [[nodiscard]] bool in_memory() const {
+            return descriptor_ >= 0;
+        }
+
+    private:
+        std::filesystem::path path_;
+        int descriptor_;
+        bool temporary_;
+    };
+
+    /**
+     * A save file to convert, either on disk or held in memory.
+     *
+     * Saves extracted from archives are held in memory by default, so they
+     * never need to be written to the output directory and read back. Saves
+     * read from disk images are views into the mapped image.
+     */
+    class SaveSource {
+    public:
+        /**
+         * Creates a source for a save file on disk.
+         *
+         * @param path the path to the save file.
+         * @param name the name of the save file; defaults to the file name of the path.
+         * @param owner an object kept alive while the source exists, e.g. the directory holding the file.
+         * @return the source.
+         */
+        static SaveSource from_file(const std::filesystem::path& path, std::wstring name = {}, std::shared_ptr<void> owner = nullptr) {
+            auto source = SaveSource {};
+
+            source.name_ = name.empty() ? path.filename().wstring() : std::move(name);
+            source.path_ = path;
+            source.size_ = std::filesystem::file_size(path);
+            source.owner_ = std::move(owner);
+
+            return source;
+        }
+
+        /**
+         * Creates a source for a save file held in memory.
+         *
+         * @param name the name of the save file.
+         * @param data the contents of the save file.
+         * @return the source.
+         */
+        static SaveSource from_buffer(std::wstring name, std::vector<uint8_t> data) {
+            auto source = SaveSource {};
+
+            const auto buffer = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+
+            source.name_ = std::move(name);
+            source.size_ = buffer->size();
+            source.data_ = std::span<const uint8_t> { buffer->data(), buffer->size() };
+            source.owner_ = buffer;
+            source.buffered_ = true;
+
+            return source;
+        }
+
+        /**
+         * Creates a source for a save file held in memory owned by another object.
+         *
+         * @param name the name of the save file.
+         * @param data the contents of the save file.
+         * @param owner the object owning the contents, e.g. a mapped disk image; kept alive while the source exists.
+         * @return the source.
+         */
+        static SaveSource from_view(std::wstring name, std::span<const uint8_t> data, std::shared_ptr<const void> owner) {
+            auto source = SaveSource {};
+
+            source.name_ = std::move(name);
+            source.size_ = data.size();
+            source.data_ = data;
+            source.owner_ = std::move(owner);
+
+            return source;
+        }
+
+        /**
+         * @return an identifier unique to this save within the process; shared by copies.
+         */
+        [[nodiscard]] uint64_t id() const {
+            return id_;
+        }
+
+        /**
+         * @return the name of the save file, used to name the outputs.
+         */
+        [[nodiscard]] const std::wstring& name() const {
+            return name_;
+        }
+
+        /**
+         * @return where the save was read from, to recognize it in a later run; see {@code journal::origin}.
+         */
+        [[nodiscard]] const std::string& origin() const {
+            return origin_;
+        }
+
+        /**
+         * @param origin where the save was read from.
+         */
+        void set_origin(std::string origin) {
+            origin_ = std::move(origin);
+        }
+
+        /**
+         * @return the size of the save file in bytes.
+         */
+        [[nodiscard]] uintmax_t size() const {
+            return size_;
+        }
+
+        /**
+         * @return whether the save file is held in memory.
+         */
+        [[nodiscard]] bool in_memory() const {
+            return data_.has_value();
+        }
+
+        /**
+         * @return whether the save file is held in a buffer of its own, rather than on disk or in memory owned by another object.
+         */
+        [[nodiscard]] bool buffered() const {
+            return buffered_;
+        }
+
+        /**
+         * @return the path of the save file, if it is on disk.
+         */
+        [[nodiscard]] const std::optional<std::filesystem::path>& path() const {
+            return path_;
+        }
+
+        /**
+         * @return the contents of the save file, if it is held in memory.
+         */
+        [[nodiscard]] std::span<const uint8_t> data() const {
+            return data_.value_or(std::span<const uint8_t> {});
+        }
+
+        /**
+         * Makes the save file available through a path.
+         *
+         * Saves on disk are returned as is. Saves held in memory are exposed
+         * through an anonymous memory file on Linux, and through a temporary
+         * file elsewhere. The file keeps the name of the save, so it is written
+         * to a folder of its own, as saves of concurrent inputs share names
+         * such as '_MinecraftSaveInfo'.
+         *
+         * @param temp_directory the directory to create the temporary folder in, if needed.
+         * @return the materialized save; the path is valid while it exists.
+         */
+        [[nodiscard]] MaterializedSave materialize(const std::filesystem::path& temp_directory) const {
+            if (path_) {
+                return { *path_, -1, false };
+            }
+
+#ifdef __linux__
+            const auto descriptor = memfd_create("x360mse-save", 0);
+
+            if (descriptor >= 0) {
+                auto materialized = MaterializedSave { std::filesystem::path("/proc/self/fd") / std::to_string(descriptor), descriptor, false };
+
+                size_t written = 0;
+
+                while (written < data_->size()) {
+                    const auto count = write(descriptor, data_->data() + written, data_->size() - written);
+
+                    if (count <= 0) {
+                        throw std::runtime_error("Failed to write save to memory file");
+                    }
+
+                    written += static_cast<size_t>(count);
+                }
+
+                return materialized;
+            }
+#endif
+
+            auto path = create_private_directory(temp_directory) / name_;
+            auto materialized = MaterializedSave { path, -1, true };
+
+            auto stream = std::ofstream { path, std::ios::binary };
+            stream.write(reinterpret_cast<const char*>(data_->data()), static_cast<std::streamsize>(data_->size()));
+
+            if (!stream) {
+                throw std::runtime_error("Failed to write save to temporary file");
+            }
+
+            return materialized;
+        }
+
+    private:
+        SaveSource()
+                : id_(next_id()) {
+        }
+
+        /**
+         * Creates a folder under a random name no other caller holds.
+         *
+         * @param directory the directory to create the folder in.
+         * @return the folder created.
+         */
+        static std::filesystem::path create_private_directory(const std::filesystem::path& directory) {
+            static thread_local std::mt19937_64 generator { std::random_device {}() };
+
+            for (;;) {
+                const auto path = directory / ("x360mse-" + x360mse::hash::to_hex(generator()));
+
+                std::error_code error;
+
+                if (std::filesystem::create_directory(path, error)) {
+                    return path;
+                }
+
+                if (!std::filesystem::exists(path)) {
+                    throw std::filesystem::filesystem_error("Failed to create temporary directory", path, error);
+                }
+            }
+        }
+
+        static uint64_t next_id() {
+            static std::atomic<uint64_t> counter = 0;
+
+            return ++counter;
+        }
+
+        uint64_t id_;
+        std::wstring name_;
+        std::string origin_;
+        std::optional<std::filesystem::path> path_;
+        uintmax_t size_ = 0;
+        std::optional<std::span<const uint8_t>> data_;
+        std::shared_ptr<const void> owner_;
+        bool buffered_ = false;
+    };
+
+    /**
+     * Receives saves as soon as they are extracted or copied, and their save
+     * bins are known, so they can be converted while the next ones are read.
+     */
+    using SaveSink = std::function<void(SaveSource)>;
+}
+
+#endif
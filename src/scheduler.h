@@ -0,0 +1,270 @@
+#ifndef X360MSE_SCHEDULER_H
+#define X360MSE_SCHEDULER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "governor.h"
+
+namespace x360mse::scheduler {
+    /**
+     * Runs conversion tasks concurrently while splitting a fixed thread
+     * budget between them.
+     *
+     * Tasks are started largest first, so that the longest conversions
+     * do not end up running alone at the end of a batch. Each task receives
+     * a share of the free threads when it starts; tasks started when few
+     * others are pending receive a larger share. A task only starts while
+     * at least one thread is free, so the running tasks never use more
+     * threads than the budget.
+     *
+     * The queue of pending tasks may be bounded, so that whoever submits
+     * tasks is held back while the running ones catch up, rather than
+     * piling up saves in memory or on disk ahead of the conversions.
+     *
+     * If a memory governor is given, a task only starts while its expected
+     * footprint fits in the memory budget next to the running ones. When the
+     * heaviest pending task does not fit, lighter ones that do are started
+     * in its place.
+     */
+    class ConversionScheduler {
+    public:
+        /**
+         * A task to run, receiving the number of threads it may use.
+         */
+        using Task = std::function<void(unsigned int)>;
+
+        /**
+         * @param max_jobs the maximum number of tasks running at once.
+         * @param max_threads the total number of threads shared by all running tasks.
+         * @param max_pending the maximum number of tasks waiting to start; 0 for no limit.
+         * @param governor the governor admitting tasks by their expected memory footprint, if any.
+         */
+        ConversionScheduler(unsigned int max_jobs, unsigned int max_threads, size_t max_pending = 0, x360mse::governor::MemoryGovernor* governor = nullptr)
+                : max_threads_(std::max(1u, max_threads)),
+                  max_jobs_(std::clamp(max_jobs, 1u, std::max(1u, max_threads))),
+                  max_pending_(max_pending),
+                  governor_(governor) {
+        }
+
+        ConversionScheduler(const ConversionScheduler&) = delete;
+        ConversionScheduler& operator=(const ConversionScheduler&) = delete;
+
+        ~ConversionScheduler() {
+            try {
+                wait();
+            } catch (...) {
+                // Exceptions can only be reported through 'wait'.
+            }
+        }
+
+        /**
+         * Queues a task.
+         *
+         * Blocks while the queue of pending tasks is full.
+         *
+         * @param weight the weight of the task, usually the size of the save; heavier tasks start first.
+         * @param task the task to run.
+         */
+        void submit(uintmax_t weight, Task task) {
+            {
+                std::unique_lock lock(mutex_);
+
+                // Wait for a worker to take a pending task; workers are
+                // always running by then, as the queue only fills up
+                // after the first submission.
+                space_condition_.wait(lock, [&]() { return max_pending_ == 0 || queue_.size() < max_pending_; });
+
+                queue_.insert(Entry { weight, sequence_++, std::move(task) });
+
+                // Spawn workers lazily, up to the job limit.
+                if (workers_.size() < max_jobs_) {
+                    workers_.emplace_back([this]() { work(); });
+                }
+            }
+
+            condition_.notify_one();
+        }
+
+        /**
+         * Waits until every queued task has finished.
+         *
+         * No tasks may be submitted afterward.
+         * Rethrows the first exception thrown by a task, if any.
+         */
+        void wait() {
+            {
+                std::lock_guard lock(mutex_);
+                closed_ = true;
+            }
+
+            condition_.notify_all();
+
+            for (auto& worker : workers_) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+
+            workers_.clear();
+
+            if (exception_) {
+                std::rethrow_exception(std::exchange(exception_, nullptr));
+            }
+        }
+
+        /**
+         * @return the maximum number of tasks running at once.
+         */
+        [[nodiscard]] unsigned int max_jobs() const {
+            return max_jobs_;
+        }
+
+        /**
+         * @return the maximum number of tasks waiting to start, or 0 if unbounded.
+         */
+        [[nodiscard]] size_t max_pending() const {
+            return max_pending_;
+        }
+
+        /**
+         * @return the total number of threads shared by all running tasks.
+         */
+        [[nodiscard]] unsigned int max_threads() const {
+            return max_threads_;
+        }
+
+    private:
+        struct Entry {
+            uintmax_t weight;
+            uint64_t sequence;
+            Task task;
+
+            bool operator<(const Entry& other) const {
+                // Heaviest first; among equal weights, first submitted first.
+                if (weight != other.weight) {
+                    return weight < other.weight;
+                }
+
+                return sequence > other.sequence;
+            }
+        };
+
+        void work() {
+            while (true) {
+                Entry entry;
+                unsigned int threads;
+                uint64_t footprint = 0;
+
+                {
+                    std::unique_lock lock(mutex_);
+
+                    auto next = queue_.end();
+
+                    condition_.wait(lock, [&]() {
+                        next = admissible();
+
+                        return (closed_ && queue_.empty()) || next != queue_.end();
+                    });
+
+                    if (queue_.empty()) {
+                        return;
+                    }
+
+                    entry = std::move(queue_.extract(next).value());
+
+                    if (governor_) {
+                        footprint = governor_->estimate(entry.weight);
+                        governor_->reserve(footprint);
+                    }
+
+                    space_condition_.notify_one();
+
+                    // Split the free threads between this task and the ones that
+                    // could still start next to it. While tasks can still be
+                    // submitted, assume every free slot will be filled.
+                    const auto free_slots = max_jobs_ - running_;
+                    const auto pending = closed_ ? queue_.size() + 1 : free_slots;
+                    const auto contenders = std::max<size_t>(1, std::min<size_t>(free_slots, pending));
+                    const auto free_threads = max_threads_ - used_threads_;
+
+                    // At least one thread is free, as tasks are only admitted then.
+                    threads = std::max(1u, static_cast<unsigned int>(free_threads / contenders));
+
+                    running_ += 1;
+                    used_threads_ += threads;
+                }
+
+                try {
+                    entry.task(threads);
+                } catch (...) {
+                    std::lock_guard lock(mutex_);
+
+                    if (!exception_) {
+                        exception_ = std::current_exception();
+                    }
+                }
+
+                {
+                    std::lock_guard lock(mutex_);
+
+                    running_ -= 1;
+                    used_threads_ -= threads;
+
+                    if (governor_) {
+                        governor_->release(footprint);
+                    }
+                }
+
+                // Threads and memory were handed back; tasks that did not fit may fit now.
+                condition_.notify_all();
+            }
+        }
+
+        /**
+         * @return the heaviest pending task allowed to start now, or the end of the queue if none is.
+         */
+        std::set<Entry>::iterator admissible() {
+            // Every thread of the budget is taken; wait for a task to hand some back.
+            if (used_threads_ >= max_threads_) {
+                return queue_.end();
+            }
+
+            for (auto entry = queue_.rbegin(); entry != queue_.rend(); ++entry) {
+                if (!governor_ || governor_->admits(governor_->estimate(entry->weight))) {
+                    return std::prev(entry.base());
+                }
+            }
+
+            return queue_.end();
+        }
+
+        const unsigned int max_threads_;
+        const unsigned int max_jobs_;
+        const size_t max_pending_;
+        x360mse::governor::MemoryGovernor* const governor_;
+
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::condition_variable space_condition_;
+        // Ordered from the lightest to the heaviest task.
+        std::set<Entry> queue_;
+        std::vector<std::thread> workers_;
+        std::exception_ptr exception_;
+
+        uint64_t sequence_ = 0;
+        unsigned int running_ = 0;
+        unsigned int used_threads_ = 0;
+        bool closed_ = false;
+    };
+}
+
+#endif
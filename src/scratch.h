@@ -0,0 +1,320 @@
+#ifndef X360MSE_SCRATCH_H
+#define X360MSE_SCRATCH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// If on Linux, 'statfs' tells whether a folder lives on a RAM-backed file system.
+#ifdef __linux__
+#include <sys/statfs.h>
+#endif
+
+#include "governor.h"
+#include "hash.h"
+
+namespace x360mse::scratch {
+    class ScratchSpace;
+
+    /**
+     * A folder leased from a {@code ScratchSpace} to hold the intermediate
+     * files of a single conversion.
+     *
+     * The folder is empty when leased, and is cleaned and handed back to
+     * the scratch space for the next conversion when the lease is destroyed.
+     */
+    class ScratchArea {
+    public:
+        /**
+         * The free bytes below which a RAM-backed file system is considered full.
+         */
+        static constexpr uintmax_t EXHAUSTED_SPACE = 64 * 1024 * 1024;
+
+        ScratchArea(ScratchSpace* owner, std::filesystem::path path, bool in_memory, uintmax_t reserved)
+                : owner_(owner), path_(std::move(path)), in_memory_(in_memory), reserved_(reserved) {
+        }
+
+        ScratchArea(const ScratchArea&) = delete;
+        ScratchArea& operator=(const ScratchArea&) = delete;
+
+        ScratchArea(ScratchArea&& other) noexcept
+                : owner_(std::exchange(other.owner_, nullptr)),
+                  path_(std::move(other.path_)),
+                  in_memory_(other.in_memory_),
+                  reserved_(other.reserved_) {
+        }
+
+        ~ScratchArea();
+
+        /**
+         * @return the folder to write intermediate files to.
+         */
+        [[nodiscard]] const std::filesystem::path& path() const {
+            return path_;
+        }
+
+        /**
+         * @return whether the folder lives in memory rather than on disk.
+         */
+        [[nodiscard]] bool in_memory() const {
+            return in_memory_;
+        }
+
+        /**
+         * Tells whether the folder lives in memory and its file system is
+         * nearly full, as when the intermediate files outgrew their estimate
+         * or another process filled it; the conversion should then be run
+         * again on disk.
+         *
+         * @return whether the folder ran out of space.
+         */
+        [[nodiscard]] bool exhausted() const {
+            if (!in_memory_) {
+                return false;
+            }
+
+            std::error_code error;
+            const auto space = std::filesystem::space(path_, error);
+
+            return !error && space.available < EXHAUSTED_SPACE;
+        }
+
+    private:
+        ScratchSpace* owner_;
+        std::filesystem::path path_;
+        bool in_memory_;
+        uintmax_t reserved_;
+    };
+
+    /**
+     * Hands out folders for the intermediate files of conversions.
+     *
+     * Folders are placed on a RAM-backed file system when the expected size
+     * of the intermediate files fits both in the memory budget and in the
+     * space left free on the file system next to the other leases, and in
+     * the disk folder otherwise. If a memory governor is given, folders in
+     * memory are held against its budget too, and the memory budget never
+     * exceeds it. The choice is made when a folder is leased, as files
+     * cannot be moved under a running conversion. Folders are cleaned and
+     * reused by later conversions rather than created and deleted for every
+     * save, and are all removed when the scratch space is destroyed.
+     */
+    class ScratchSpace {
+    public:
+        /**
+         * How many times the size of a save its intermediate files are expected to take.
+         *
+         * Saves are compressed; the converter unpacks their regions before converting them.
+         */
+        static constexpr uintmax_t INTERMEDIATE_FACTOR = 4;
+
+        /**
+         * How many times the size of a save its converted world is expected to take.
+         */
+        static constexpr uintmax_t WORLD_FACTOR = 4;
+
+        /**
+         * @param disk_directory the folder to place scratch folders in when they do not fit in memory.
+         * @param memory_budget the bytes of memory scratch folders may take in total; if unset,
+         *                      half of the RAM-backed file system is used, and 0 disables it.
+         * @param governor the governor to hold folders in memory against, if any; must outlive the scratch space.
+         */
+        ScratchSpace(const std::filesystem::path& disk_directory, std::optional<uintmax_t> memory_budget, x360mse::governor::MemoryGovernor* governor = nullptr)
+                : governor_(governor) {
+            auto random = std::mt19937_64 { std::random_device {}() };
+            const auto root_name = "x360mse-scratch-" + x360mse::hash::to_hex(random());
+
+            disk_.directory = disk_directory / root_name;
+            std::filesystem::create_directories(disk_.directory);
+
+            const auto memory_directory = find_memory_directory();
+
+            if (!memory_directory) {
+                return;
+            }
+
+            std::error_code error;
+            const auto space = std::filesystem::space(*memory_directory, error);
+
+            memory_budget_ = memory_budget.value_or(error ? 0 : space.capacity / 2);
+
+            // Files on a RAM-backed file system take memory; never plan for more than the process may take.
+            if (governor_ && governor_->budget()) {
+                memory_budget_ = std::min<uintmax_t>(memory_budget_, *governor_->budget());
+            }
+
+            if (memory_budget_ == 0) {
+                return;
+            }
+
+            memory_ = Root {};
+            memory_->directory = *memory_directory / root_name;
+
+            std::filesystem::create_directories(memory_->directory, error);
+
+            if (error) {
+                memory_.reset();
+            }
+        }
+
+        ScratchSpace(const ScratchSpace&) = delete;
+        ScratchSpace& operator=(const ScratchSpace&) = delete;
+
+        ~ScratchSpace() {
+            std::error_code error;
+
+            std::filesystem::remove_all(disk_.directory, error);
+
+            if (memory_) {
+                std::filesystem::remove_all(memory_->directory, error);
+            }
+        }
+
+        /**
+         * Finds a RAM-backed file system to place scratch folders in.
+         *
+         * @return the folder of the file system, if there is one.
+         */
+        static std::optional<std::filesystem::path> find_memory_directory() {
+#ifdef __linux__
+            // The magic number of tmpfs, from 'linux/magic.h'.
+            constexpr auto TMPFS_MAGIC = 0x01021994;
+
+            for (const auto* candidate : { "/dev/shm", "/run/shm" }) {
+                struct statfs info {};
+
+                if (statfs(candidate, &info) == 0 && info.f_type == TMPFS_MAGIC) {
+                    return std::filesystem::path(candidate);
+                }
+            }
+#endif
+
+            return std::nullopt;
+        }
+
+        /**
+         * Leases an empty folder for the intermediate files of a conversion.
+         *
+         * @param expected_size the bytes the intermediate files are expected to take.
+         * @return the leased folder; handed back when destroyed.
+         */
+        ScratchArea acquire(uintmax_t expected_size) {
+            std::lock_guard lock(mutex_);
+
+            if (memory_ && memory_reserved_ + expected_size <= memory_budget_) {
+                std::error_code error;
+                const auto space = std::filesystem::space(memory_->directory, error);
+
+                // Leave room for the leases still filling up, as well as for other processes,
+                // and for the conversions and saves held in memory by the governor.
+                if (!error && space.available >= memory_reserved_ + expected_size + ScratchArea::EXHAUSTED_SPACE
+                        && (!governor_ || governor_->try_hold(expected_size))) {
+                    memory_reserved_ += expected_size;
+
+                    return { this, take(*memory_), true, expected_size };
+                }
+            }
+
+            return { this, take(disk_), false, 0 };
+        }
+
+        /**
+         * Leases an empty folder on disk, e.g. to run a conversion again after its folder in memory ran out of space.
+         *
+         * @return the leased folder; handed back when destroyed.
+         */
+        ScratchArea acquire_on_disk() {
+            std::lock_guard lock(mutex_);
+
+            return { this, take(disk_), false, 0 };
+        }
+
+        /**
+         * @return the bytes of memory scratch folders may take in total.
+         */
+        [[nodiscard]] uintmax_t memory_budget() const {
+            return memory_ ? memory_budget_ : 0;
+        }
+
+    private:
+        friend class ScratchArea;
+
+        struct Root {
+            std::filesystem::path directory;
+            std::vector<std::filesystem::path> free_areas;
+            size_t area_total = 0;
+        };
+
+        static std::filesystem::path take(Root& root) {
+            if (!root.free_areas.empty()) {
+                auto path = std::move(root.free_areas.back());
+                root.free_areas.pop_back();
+
+                return path;
+            }
+
+            auto path = root.directory / std::to_string(root.area_total++);
+            std::filesystem::create_directories(path);
+
+            return path;
+        }
+
+        void release(const std::filesystem::path& path, bool in_memory, uintmax_t reserved) {
+            // Clean the folder outside the lock, as it may hold many files.
+            std::error_code error;
+            std::vector<std::filesystem::path> entries;
+
+            for (auto entry = std::filesystem::directory_iterator(path, error); !error && entry != std::filesystem::directory_iterator(); entry.increment(error)) {
+                entries.push_back(entry->path());
+            }
+
+            for (const auto& entry : entries) {
+                if (!error) {
+                    std::filesystem::remove_all(entry, error);
+                }
+            }
+
+            std::lock_guard lock(mutex_);
+
+            auto& root = in_memory ? *memory_ : disk_;
+
+            if (in_memory) {
+                memory_reserved_ -= reserved;
+
+                if (governor_) {
+                    governor_->drop(reserved);
+                }
+            }
+
+            if (error) {
+                // The folder could not be cleaned; drop it rather than leak files into the next conversion.
+                std::filesystem::remove_all(path, error);
+                return;
+            }
+
+            root.free_areas.push_back(path);
+        }
+
+        x360mse::governor::MemoryGovernor* const governor_ = nullptr;
+
+        std::mutex mutex_;
+        Root disk_;
+        std::optional<Root> memory_;
+        uintmax_t memory_budget_ = 0;
+        uintmax_t memory_reserved_ = 0;
+    };
+
+    inline ScratchArea::~ScratchArea() {
+        if (owner_) {
+            owner_->release(path_, in_memory_, reserved_);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef X360MSE_SELECTION_H
+#define X360MSE_SELECTION_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <je2be.hpp>
+
+namespace x360mse::selection {
+    /**
+     * A box of chunks, bounds included.
+     */
+    struct ChunkBox {
+        int32_t min_x;
+        int32_t min_z;
+        int32_t max_x;
+        int32_t max_z;
+
+        /**
+         * @return the number of chunks in the box.
+         */
+        [[nodiscard]] uint64_t chunk_count() const {
+            return static_cast<uint64_t>(static_cast<int64_t>(max_x) - min_x + 1) * static_cast<uint64_t>(static_cast<int64_t>(max_z) - min_z + 1);
+        }
+    };
+
+    /**
+     * The part of a world to convert: some of its dimensions, and the chunks
+     * within a box. Everything is converted by default.
+     *
+     * The selection is handed to the converter, which skips the regions and
+     * chunks outside it before decompressing them.
+     */
+    struct Selection {
+        /**
+         * The largest number of chunks a box may hold, as the converter takes
+         * the chunks to convert one by one.
+         */
+        static constexpr uint64_t MAX_CHUNK_COUNT = 1024 * 1024;
+
+        std::set<mcfile::Dimension> dimensions;
+        std::optional<ChunkBox> box;
+
+        /**
+         * Parses a comma-separated list of dimensions.
+         *
+         * @param text the dimensions, e.g. 'overworld,nether'; 'end' and 'the_end' both name the End.
+         * @return the dimensions.
+         * @throws std::invalid_argument if a name is not a dimension, or none is given.
+         */
+        static std::set<mcfile::Dimension> parse_dimensions(const std::string& text) {
+            std::set<mcfile::Dimension> dimensions;
+            size_t start = 0;
+
+            while (start <= text.size()) {
+                const auto end = std::min(text.find(',', start), text.size());
+                const auto name = text.substr(start, end - start);
+
+                if (name == "overworld") {
+                    dimensions.insert(mcfile::Dimension::Overworld);
+                } else if (name == "nether" || name == "the_nether") {
+                    dimensions.insert(mcfile::Dimension::Nether);
+                } else if (name == "end" || name == "the_end") {
+                    dimensions.insert(mcfile::Dimension::End);
+                } else if (!name.empty()) {
+                    throw std::invalid_argument("Unknown dimension: " + name);
+                }
+
+                start = end + 1;
+            }
+
+            if (dimensions.empty()) {
+                throw std::invalid_argument("No dimension given");
+            }
+
+            return dimensions;
+        }
+
+        /**
+         * Parses a box of chunks.
+         *
+         * @param text the box, as 'x0,z0,x1,z1' in chunk coordinates; corners may be given in any order.
+         * @return the box.
+         * @throws std::invalid_argument if the text is not a box, or it holds too many chunks.
+         */
+        static ChunkBox parse_box(const std::string& text) {
+            std::array<int32_t, 4> coordinates {};
+            size_t offset = 0;
+
+            for (size_t i = 0; i < coordinates.size(); i += 1) {
+                const auto end = i + 1 == coordinates.size() ? text.size() : text.find(',', offset);
+
+                if (end == std::string::npos || end == offset) {
+                    throw std::invalid_argument("Bounding box must be given as x0,z0,x1,z1: " + text);
+                }
+
+                size_t parsed = 0;
+                coordinates[i] = std::stoi(text.substr(offset, end - offset), &parsed);
+
+                if (parsed != end - offset) {
+                    throw std::invalid_argument("Bounding box must be given as x0,z0,x1,z1: " + text);
+                }
+
+                offset = end + 1;
+            }
+
+            const auto box = ChunkBox {
+                    std::min(coordinates[0], coordinates[2]),
+                    std::min(coordinates[1], coordinates[3]),
+                    std::max(coordinates[0], coordinates[2]),
+                    std::max(coordinates[1], coordinates[3]),
+            };
+
+            if (box.chunk_count() > MAX_CHUNK_COUNT) {
+                throw std::invalid_argument("Bounding box holds more than " + std::to_string(MAX_CHUNK_COUNT) + " chunks: " + text);
+            }
+
+            return box;
+        }
+
+        /**
+         * @return a string identifying the selection, to tell worlds converted with different ones apart.
+         */
+        [[nodiscard]] std::string fingerprint() const {
+            std::string fingerprint;
+
+            for (const auto dimension : dimensions) {
+                fingerprint += "dimension=" + std::to_string(static_cast<int>(dimension)) + ";";
+            }
+
+            if (box) {
+                fingerprint += "box=" + std::to_string(box->min_x) + "," + std::to_string(box->min_z) + "," + std::to_string(box->max_x) + "," + std::to_string(box->max_z) + ";";
+            }
+
+            return fingerprint;
+        }
+
+        /**
+         * Restricts a conversion to the selection.
+         *
+         * @param options the options of the converter.
+         */
+        void apply(je2be::Options& options) const {
+            for (const auto dimension : dimensions) {
+                options.fDimensionFilter.insert(dimension);
+            }
+
+            if (box) {
+                for (auto x = box->min_x; x <= box->max_x; x += 1) {
+                    for (auto z = box->min_z; z <= box->max_z; z += 1) {
+                        options.fChunkFilter.insert(je2be::Pos2i(x, z));
+                    }
+                }
+            }
+        }
+    };
+}
+
+#endif
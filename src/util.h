@@ -2,6 +2,9 @@
 #define X360MSE_UTIL_H
 
 #include <chrono>
+#include <codecvt>
+#include <functional>
+#include <locale>
 #include <string>
 
 namespace x360mse::util {
@@ -10,27 +13,78 @@ namespace x360mse::util {
      *
      * @tparam T the return type of the function.
      * @param function the function to measure the time taken by.
-     * @return pair of the time taken in milliseconds and the return value of the function.
+     * @return pair of the time taken and the return value of the function.
      */
     template<typename T>
-    std::pair<long long, T> run_measuring_ms(std::function<T()> function) {
+    std::pair<std::chrono::nanoseconds, T> run_measuring(std::function<T()> function) {
         const auto then = std::chrono::steady_clock::now();
         auto value = function();
         const auto now = std::chrono::steady_clock::now();
-        return std::make_pair(std::chrono::duration_cast<std::chrono::milliseconds>(now - then).count(), value);
+        return std::make_pair(std::chrono::duration_cast<std::chrono::nanoseconds>(now - then), value);
     }
 
     /**
      * Measure the time taken by a function to execute.
      *
      * @param function the function to measure the time taken by.
-     * @return the time taken in milliseconds.
+     * @return the time taken.
      */
-    long long run_measuring_ms(const std::function<void()>& function) {
+    inline std::chrono::nanoseconds run_measuring(const std::function<void()>& function) {
         const auto then = std::chrono::steady_clock::now();
         function();
         const auto now = std::chrono::steady_clock::now();
-        return std::chrono::duration_cast<std::chrono::milliseconds>(now - then).count();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now - then);
+    }
+
+    /**
+     * Measure the time taken by a function to execute.
+     *
+     * @param function the function to measure the time taken by.
+     * @param report the function to report the time taken to, e.g. to record it in a metrics report.
+     * @return the time taken in milliseconds.
+     */
+    inline long long run_measuring_ms(const std::function<void()>& function, const std::function<void(std::chrono::nanoseconds)>& report) {
+        const auto duration = run_measuring(function);
+        report(duration);
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+
+    /**
+     * Measure the time taken by a function to execute.
+     *
+     * @tparam T the return type of the function.
+     * @param function the function to measure the time taken by.
+     * @return pair of the time taken in milliseconds and the return value of the function.
+     */
+    template<typename T>
+    std::pair<long long, T> run_measuring_ms(std::function<T()> function) {
+        auto [duration, value] = run_measuring<T>(std::move(function));
+        return std::make_pair(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(), std::move(value));
+    }
+
+    /**
+     * Measure the time taken by a function to execute.
+     *
+     * @tparam T the return type of the function.
+     * @param function the function to measure the time taken by.
+     * @param report the function to report the time taken to, e.g. to record it in a metrics report.
+     * @return pair of the time taken in milliseconds and the return value of the function.
+     */
+    template<typename T>
+    std::pair<long long, T> run_measuring_ms(std::function<T()> function, const std::function<void(std::chrono::nanoseconds)>& report) {
+        auto [duration, value] = run_measuring<T>(std::move(function));
+        report(duration);
+        return std::make_pair(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(), std::move(value));
+    }
+
+    /**
+     * Measure the time taken by a function to execute.
+     *
+     * @param function the function to measure the time taken by.
+     * @return the time taken in milliseconds.
+     */
+    inline long long run_measuring_ms(const std::function<void()>& function) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(run_measuring(function)).count();
     }
 
     /**
@@ -39,7 +93,7 @@ namespace x360mse::util {
      * @param data the wide string to convert.
      * @return the converted string.
      */
-    std::wstring to_wstring(const std::string& data) {
+    inline std::wstring to_wstring(const std::string& data) {
         std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
         return converter.from_bytes(data);
     }
@@ -47,14 +101,25 @@ namespace x360mse::util {
     /**
      * Convert a u16string to a wide string.
      */
-    std::wstring to_wstring(const std::u16string& data) {
+    inline std::wstring to_wstring(const std::u16string& data) {
         return { data.begin(), data.end() };
     }
 
+    /**
+     * Convert a wide string to a UTF-8 string.
+     *
+     * @param data the wide string to convert.
+     * @return the converted string.
+     */
+    inline std::string to_utf8(const std::wstring& data) {
+        std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+        return converter.to_bytes(data);
+    }
+
     /**
      * Convert a u16string to a string.
      */
-    std::string to_string(const std::u16string& data) {
+    inline std::string to_string(const std::u16string& data) {
         return {data.begin(), data.end()};
     }
 }
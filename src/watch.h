@@ -0,0 +1,242 @@
+#ifndef X360MSE_WATCH_H
+#define X360MSE_WATCH_H
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// If on Linux, the drop folder is watched through inotify; elsewhere, it is
+// scanned at regular intervals.
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace x360mse::watch {
+    namespace detail {
+        inline std::atomic<bool> stop_requested = false;
+
+        static_assert(std::atomic<bool>::is_always_lock_free, "Stop requests are made from signal handlers");
+
+        inline void request_stop(int) {
+            stop_requested = true;
+        }
+    }
+
+    /**
+     * Stops watching once the process is interrupted or asked to terminate,
+     * rather than dying with conversions half done.
+     */
+    inline void handle_stop_signals() {
+        std::signal(SIGINT, detail::request_stop);
+        std::signal(SIGTERM, detail::request_stop);
+    }
+
+    /**
+     * @return whether the process was asked to stop.
+     */
+    inline bool stop_requested() {
+        return detail::stop_requested;
+    }
+
+    /**
+     * Reports the files and folders landing in a drop folder.
+     *
+     * Entries are only reported once they are complete: on Linux, when a
+     * file written in the folder is closed, or when a file or folder is
+     * moved into it; elsewhere, when its size and modification time stop
+     * changing between two scans. Folders should thus be moved into the
+     * drop folder rather than written in place. Entries whose name starts
+     * with a dot are ignored, so uploads may be written under a hidden name
+     * and renamed once complete.
+     *
+     * The entries already in the folder are reported first.
+     */
+    class DropWatcher {
+    public:
+        /**
+         * The interval between two scans, where the folder is scanned.
+         */
+        static constexpr auto SCAN_INTERVAL = std::chrono::seconds(1);
+
+        /**
+         * @param directory the drop folder.
+         * @throws std::runtime_error if the folder cannot be watched.
+         */
+        explicit DropWatcher(std::filesystem::path directory) : directory_(std::move(directory)) {
+            std::filesystem::create_directories(directory_);
+
+#ifdef __linux__
+            descriptor_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+            if (descriptor_ < 0 || inotify_add_watch(descriptor_, directory_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+                throw std::runtime_error("Failed to watch " + directory_.string() + ": " + std::generic_category().message(errno));
+            }
+#endif
+        }
+
+        DropWatcher(const DropWatcher&) = delete;
+        DropWatcher& operator=(const DropWatcher&) = delete;
+
+        ~DropWatcher() {
+#ifdef __linux__
+            if (descriptor_ >= 0) {
+                close(descriptor_);
+            }
+#endif
+        }
+
+        /**
+         * Waits for entries to land in the drop folder.
+         *
+         * @param timeout how long to wait at most.
+         * @return the entries that landed, if any.
+         */
+        std::vector<std::filesystem::path> wait(std::chrono::milliseconds timeout) {
+            if (!scanned_) {
+                scanned_ = true;
+
+                return initial_entries();
+            }
+
+#ifdef __linux__
+            auto descriptor = pollfd { descriptor_, POLLIN, 0 };
+
+            if (poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+                return {};
+            }
+
+            std::set<std::filesystem::path> landed;
+            alignas(inotify_event) char buffer[16 * 1024];
+
+            while (true) {
+                const auto length = read(descriptor_, buffer, sizeof(buffer));
+
+                if (length <= 0) {
+                    break;
+                }
+
+                for (ssize_t offset = 0; offset < length;) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+
+                    if (event->len > 0 && event->name[0] != '.') {
+                        landed.insert(directory_ / event->name);
+                    }
+
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                }
+            }
+
+            return { landed.begin(), landed.end() };
+#else
+            std::this_thread::sleep_for(std::min<std::chrono::milliseconds>(timeout, SCAN_INTERVAL));
+
+            return scan();
+#endif
+        }
+
+    private:
+        struct Snapshot {
+            uintmax_t size;
+            std::filesystem::file_time_type modification_time;
+            bool reported;
+        };
+
+        static bool hidden(const std::filesystem::path& path) {
+            const auto name = path.filename().wstring();
+
+            return name.empty() || name.front() == L'.';
+        }
+
+        std::vector<std::filesystem::path> initial_entries() {
+            std::vector<std::filesystem::path> entries;
+            std::error_code error;
+
+            for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+                if (hidden(entry.path())) {
+                    continue;
+                }
+
+                entries.push_back(entry.path());
+
+#ifndef __linux__
+                snapshots_[entry.path()] = Snapshot { size_of(entry.path()), std::filesystem::last_write_time(entry.path(), error), true };
+#endif
+            }
+
+            return entries;
+        }
+
+#ifndef __linux__
+        static uintmax_t size_of(const std::filesystem::path& path) {
+            std::error_code error;
+
+            if (!std::filesystem::is_directory(path, error)) {
+                const auto size = std::filesystem::file_size(path, error);
+
+                return error ? 0 : size;
+            }
+
+            uintmax_t size = 0;
+
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path, error)) {
+                if (entry.is_regular_file(error)) {
+                    size += entry.file_size(error);
+                }
+            }
+
+            return size;
+        }
+
+        std::vector<std::filesystem::path> scan() {
+            std::vector<std::filesystem::path> landed;
+            std::set<std::filesystem::path> present;
+            std::error_code error;
+
+            for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+                if (hidden(entry.path())) {
+                    continue;
+                }
+
+                present.insert(entry.path());
+
+                const auto snapshot = Snapshot { size_of(entry.path()), std::filesystem::last_write_time(entry.path(), error), false };
+                const auto previous = snapshots_.find(entry.path());
+
+                if (previous == snapshots_.end() || previous->second.size != snapshot.size || previous->second.modification_time != snapshot.modification_time) {
+                    // Still being written; wait for it to settle.
+                    snapshots_[entry.path()] = snapshot;
+                } else if (!previous->second.reported) {
+                    previous->second.reported = true;
+                    landed.push_back(entry.path());
+                }
+            }
+
+            // Forget removed entries, so they are reported again if dropped again.
+            std::erase_if(snapshots_, [&](const auto& snapshot) {
+                return !present.contains(snapshot.first);
+            });
+
+            return landed;
+        }
+
+        std::map<std::filesystem::path, Snapshot> snapshots_;
+#else
+        int descriptor_ = -1;
+#endif
+
+        std::filesystem::path directory_;
+        bool scanned_ = false;
+    };
+}
+
+#endif
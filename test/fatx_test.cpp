@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "fatx.h"
+
+// Checks the FATX reader against small synthetic images, as it parses
+// untrusted disk images.
+
+namespace {
+    int failures = 0;
+
+    /**
+     * Reports a failed check.
+     *
+     * @param name the name of the check.
+     * @param passed whether the check passed.
+     */
+    void check(const std::string& name, bool passed) {
+        if (!passed) {
+            std::printf("FAILED %s\n", name.c_str());
+
+            failures += 1;
+        }
+    }
+
+    /**
+     * @param function the function to run.
+     * @return whether the function threw a 'std::runtime_error'.
+     */
+    bool throws(const std::function<void()>& function) {
+        try {
+            function();
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Builds a single FATX partition in memory, with clusters of a single
+     * sector and 16-bit allocation table entries.
+     */
+    class ImageBuilder {
+    public:
+        static constexpr uint64_t CLUSTER_SIZE = 512;
+        static constexpr uint64_t DATA_OFFSET = x360mse::fatx::HEADER_SIZE + 0x1000;
+
+        /**
+         * @param data_clusters the number of clusters to allocate after the allocation table.
+         * @param root_cluster the first cluster of the root directory.
+         */
+        ImageBuilder(uint32_t data_clusters, uint32_t root_cluster)
+                : bytes_(DATA_OFFSET + data_clusters * CLUSTER_SIZE, 0) {
+            std::copy(x360mse::fatx::MAGIC.begin(), x360mse::fatx::MAGIC.end(), bytes_.begin());
+
+            write_u32(0x08, 1);
+            write_u32(0x0C, root_cluster);
+        }
+
+        /**
+         * Links a cluster to the next one of its chain.
+         *
+         * @param cluster the cluster.
+         * @param next the next cluster, or nothing to end the chain.
+         */
+        void link(uint32_t cluster, std::optional<uint32_t> next) {
+            write_u16(x360mse::fatx::HEADER_SIZE + cluster * 2, next.value_or(0xFFFF));
+        }
+
+        /**
+         * Writes a directory entry.
+         *
+         * @param cluster the cluster of the directory.
+         * @param slot the index of the entry in the cluster.
+         * @param name the name of the entry.
+         * @param directory whether the entry is a directory.
+         * @param first_cluster the first cluster of the entry.
+         * @param size the size of the file in bytes.
+         * @param name_length the length byte to write, if not the length of the name, e.g. 0xE5 for a deleted entry.
+         */
+        void entry(uint32_t cluster, uint32_t slot, const std::string& name, bool directory, uint32_t first_cluster, uint32_t size, std::optional<uint8_t> name_length = std::nullopt) {
+            const auto offset = cluster_offset(cluster) + slot * x360mse::fatx::ENTRY_SIZE;
+
+            bytes_[offset] = name_length.value_or(static_cast<uint8_t>(name.size()));
+            bytes_[offset + 1] = directory ? 0x10 : 0x00;
+            std::copy(name.begin(), name.end(), bytes_.begin() + static_cast<std::ptrdiff_t>(offset + 2));
+
+            write_u32(offset + 0x2C, first_cluster);
+            write_u32(offset + 0x30, size);
+        }
+
+        /**
+         * Ends a directory after the specified slot.
+         *
+         * @param cluster the cluster of the directory.
+         * @param slot the index of the first unused entry.
+         */
+        void end_directory(uint32_t cluster, uint32_t slot) {
+            bytes_[cluster_offset(cluster) + slot * x360mse::fatx::ENTRY_SIZE] = 0xFF;
+        }
+
+        /**
+         * Writes the contents of a file across the specified clusters.
+         *
+         * @param clusters the clusters holding the file, in order.
+         * @param contents the contents of the file.
+         */
+        void file(const std::vector<uint32_t>& clusters, const std::vector<uint8_t>& contents) {
+            for (size_t index = 0; index < clusters.size(); index += 1) {
+                const auto begin = index * CLUSTER_SIZE;
+                const auto end = std::min<size_t>(contents.size(), begin + CLUSTER_SIZE);
+
+                std::copy(contents.begin() + static_cast<std::ptrdiff_t>(begin), contents.begin() + static_cast<std::ptrdiff_t>(end), bytes_.begin() + static_cast<std::ptrdiff_t>(cluster_offset(clusters[index])));
+
+                link(clusters[index], index + 1 < clusters.size() ? std::make_optional(clusters[index + 1]) : std::nullopt);
+            }
+        }
+
+        /**
+         * Writes the image to a file.
+         *
+         * @param path the file to write.
+         */
+        void write(const std::filesystem::path& path) const {
+            auto stream = std::ofstream { path, std::ios::binary };
+            stream.write(reinterpret_cast<const char*>(bytes_.data()), static_cast<std::streamsize>(bytes_.size()));
+        }
+
+    private:
+        static uint64_t cluster_offset(uint32_t cluster) {
+            return DATA_OFFSET + (cluster - 1) * CLUSTER_SIZE;
+        }
+
+        void write_u32(uint64_t offset, uint32_t value) {
+            for (int i = 0; i < 4; i += 1) {
+                bytes_[offset + i] = static_cast<uint8_t>(value >> (24 - i * 8));
+            }
+        }
+
+        void write_u16(uint64_t offset, uint32_t value) {
+            bytes_[offset] = static_cast<uint8_t>(value >> 8);
+            bytes_[offset + 1] = static_cast<uint8_t>(value);
+        }
+
+        std::vector<uint8_t> bytes_;
+    };
+
+    /**
+     * @param size the number of bytes.
+     * @param seed the value of the first byte.
+     * @return bytes counting up from the seed.
+     */
+    std::vector<uint8_t> pattern(size_t size, uint8_t seed) {
+        std::vector<uint8_t> bytes(size);
+
+        for (size_t index = 0; index < size; index += 1) {
+            bytes[index] = static_cast<uint8_t>(seed + index * 7);
+        }
+
+        return bytes;
+    }
+
+    /**
+     * @param files the files listed.
+     * @param path the path to find.
+     * @return the number of files listed under the path.
+     */
+    size_t count(const std::vector<x360mse::fatx::File>& files, const std::string& path) {
+        return std::ranges::count(files, path, &x360mse::fatx::File::path);
+    }
+
+    /**
+     * @param files the files listed.
+     * @param path the path to find.
+     * @return the file listed under the path.
+     */
+    const x360mse::fatx::File& find(const std::vector<x360mse::fatx::File>& files, const std::string& path) {
+        return *std::ranges::find(files, path, &x360mse::fatx::File::path);
+    }
+}
+
+int main() {
+    const auto image_path = std::filesystem::temp_directory_path() / "x360mse-fatx-test.img";
+
+    // Root directory at cluster 1, spanning clusters 1 and 2.
+    //
+    //   contiguous.bin  1000 bytes in clusters 3-4
+    //   (deleted entry)
+    //   fragmented.bin  1200 bytes in clusters 5, 9, 7
+    //   empty.bin       0 bytes
+    //   Saves/          clusters 10 and 11, chained back into cluster 10
+    //     nested.bin    100 bytes in cluster 12
+    //     up/           cluster 1, the root, again
+    //     chained.bin   in cluster 11, sharing cluster 12 with 'nested.bin'
+    //   outside.bin     first cluster past the allocation table
+    //   broken.bin      chain leaving the allocation table after cluster 13
+    //   looping.bin     chain looping between clusters 14 and 15
+    //   truncated.bin   claims more than its chain holds, in cluster 16
+    //   Missing/        first cluster past the allocation table
+    ImageBuilder builder { 20, 1 };
+
+    const auto contiguous = pattern(1000, 1);
+    const auto fragmented = pattern(1200, 2);
+    const auto nested = pattern(100, 3);
+
+    builder.link(1, 2);
+    builder.link(2, std::nullopt);
+
+    builder.entry(1, 0, "contiguous.bin", false, 3, static_cast<uint32_t>(contiguous.size()));
+    builder.file({ 3, 4 }, contiguous);
+
+    builder.entry(1, 1, "deleted.bin", false, 6, 10, 0xE5);
+
+    builder.entry(1, 2, "fragmented.bin", false, 5, static_cast<uint32_t>(fragmented.size()));
+    builder.file({ 5, 9, 7 }, fragmented);
+
+    builder.entry(1, 3, "empty.bin", false, 0, 0);
+
+    builder.entry(1, 4, "Saves", true, 10, 0);
+    builder.link(10, 11);
+    builder.link(11, 10);
+    builder.entry(10, 0, "nested.bin", false, 12, static_cast<uint32_t>(nested.size()));
+    builder.file({ 12 }, nested);
+    builder.entry(10, 1, "up", true, 1, 0);
+
+    // Fill the rest of both clusters, so reading goes on through the chain and back into cluster 10.
+    for (uint32_t slot = 2; slot < ImageBuilder::CLUSTER_SIZE / x360mse::fatx::ENTRY_SIZE; slot += 1) {
+        builder.entry(10, slot, "gone.bin", false, 0, 0, 0xE5);
+    }
+
+    builder.entry(11, 0, "chained.bin", false, 12, static_cast<uint32_t>(nested.size()));
+
+    for (uint32_t slot = 1; slot < ImageBuilder::CLUSTER_SIZE / x360mse::fatx::ENTRY_SIZE; slot += 1) {
+        builder.entry(11, slot, "gone.bin", false, 0, 0, 0xE5);
+    }
+
+    builder.entry(1, 5, "outside.bin", false, 5000, 100);
+
+    builder.entry(1, 6, "broken.bin", false, 13, 700);
+    builder.link(13, 4000);
+
+    builder.entry(1, 7, "looping.bin", false, 14, 2000);
+    builder.link(14, 15);
+    builder.link(15, 14);
+
+    builder.entry(2, 0, "truncated.bin", false, 16, 900);
+    builder.link(16, std::nullopt);
+
+    builder.entry(2, 1, "Missing", true, 6000, 0);
+    builder.end_directory(2, 2);
+
+    builder.write(image_path);
+
+    check("image is detected", x360mse::fatx::FatxImage::is_image(image_path));
+
+    const auto image = x360mse::fatx::FatxImage::open(image_path);
+
+    check("one partition", image->partitions().size() == 1);
+    check("16-bit allocation table", image->partitions().front().table_entry_size == 2);
+
+    const auto files = image->list_files([](const std::string& name) { return name != "empty.bin"; });
+
+    // Every file is listed once, even though 'Saves' loops twice: through its cluster chain, and back to the root.
+    for (const auto* path : { "contiguous.bin", "fragmented.bin", "Saves/nested.bin", "Saves/chained.bin", "outside.bin", "broken.bin", "looping.bin", "truncated.bin" }) {
+        check(std::string("lists ") + path + " once", count(files, path) == 1);
+    }
+
+    check("skips deleted entries", count(files, "deleted.bin") == 0);
+    check("skips excluded files", count(files, "empty.bin") == 0);
+    check("lists nothing else", files.size() == 8);
+
+    // Contiguous files are viewed in place, and read the same.
+    {
+        const auto& file = find(files, "contiguous.bin");
+        const auto view = image->view(file);
+
+        check("views contiguous files", view && std::ranges::equal(*view, contiguous));
+        check("reads contiguous files", image->read(file) == contiguous);
+    }
+
+    // Fragmented files cannot be viewed, but are read by following their chain.
+    {
+        const auto& file = find(files, "fragmented.bin");
+
+        check("does not view fragmented files", !image->view(file));
+        check("reads fragmented files", image->read(file) == fragmented);
+    }
+
+    check("reads files in subdirectories", image->read(find(files, "Saves/nested.bin")) == nested);
+
+    // Chains leaving the allocation table, looping or ending early are reported rather than read.
+    {
+        const auto& outside = find(files, "outside.bin");
+        const auto& broken = find(files, "broken.bin");
+        const auto& looping = find(files, "looping.bin");
+        const auto& truncated = find(files, "truncated.bin");
+
+        check("view rejects out-of-range first clusters", throws([&]() { (void) image->view(outside); }));
+        check("read rejects out-of-range first clusters", throws([&]() { (void) image->read(outside); }));
+        check("view gives up on chains leaving the table", !image->view(broken));
+        check("read rejects chains leaving the table", throws([&]() { (void) image->read(broken); }));
+        check("read rejects looping chains", throws([&]() { (void) image->read(looping); }));
+        check("read rejects files longer than their chain", throws([&]() { (void) image->read(truncated); }));
+    }
+
+    // A file in the last cluster of the table, which lies past the end of the image.
+    {
+        const auto& partition = image->partitions().front();
+        const auto past_end = x360mse::fatx::File { 0, "past-end.bin", partition.cluster_count, 10 };
+
+        check("view rejects clusters past the end of the image", throws([&]() { (void) image->view(past_end); }));
+        check("read rejects clusters past the end of the image", throws([&]() { (void) image->read(past_end); }));
+    }
+
+    std::error_code error;
+    std::filesystem::remove(image_path, error);
+
+    // A file without the magic number is not an image.
+    {
+        const auto other_path = std::filesystem::temp_directory_path() / "x360mse-fatx-test.bin";
+
+        {
+            auto stream = std::ofstream { other_path, std::ios::binary };
+            stream << "not an image";
+        }
+
+        check("other files are not images", !x360mse::fatx::FatxImage::is_image(other_path));
+        check("other files cannot be opened", throws([&]() { (void) x360mse::fatx::FatxImage::open(other_path); }));
+
+        std::filesystem::remove(other_path, error);
+    }
+
+    if (failures == 0) {
+        std::printf("All FATX checks passed.\n");
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "hash.h"
+
+// Checks the XXH64 implementation against the reference implementation,
+// as its hashes are persisted as cache keys.
+
+namespace {
+    int failures = 0;
+
+    /**
+     * Reports a mismatch between a hash and its expected value.
+     *
+     * @param name the name of the check.
+     * @param actual the hash computed.
+     * @param expected the hash of the reference implementation.
+     */
+    void check(const std::string& name, uint64_t actual, uint64_t expected) {
+        if (actual != expected) {
+            std::printf("FAILED %s: got %016llx, expected %016llx\n", name.c_str(),
+                        static_cast<unsigned long long>(actual), static_cast<unsigned long long>(expected));
+
+            failures += 1;
+        }
+    }
+
+    struct KnownAnswer {
+        std::string input;
+        uint64_t hash;
+    };
+
+    /**
+     * @return the bytes 0 to 255 repeated 4 times, followed by 'xyz'; spans many stripes and leaves a tail.
+     */
+    std::string long_input() {
+        std::string input;
+
+        for (int repeat = 0; repeat < 4; repeat += 1) {
+            for (int byte = 0; byte < 256; byte += 1) {
+                input.push_back(static_cast<char>(byte));
+            }
+        }
+
+        return input + "xyz";
+    }
+
+    /**
+     * @return the bytes 0 to 31; exactly one stripe.
+     */
+    std::string stripe_input() {
+        std::string input;
+
+        for (int byte = 0; byte < 32; byte += 1) {
+            input.push_back(static_cast<char>(byte));
+        }
+
+        return input;
+    }
+}
+
+int main() {
+    // Values of the reference implementation, with a seed of 0.
+    const std::vector<KnownAnswer> answers {
+            { "", 0xef46db3751d8e999ULL },
+            { "a", 0xd24ec4f1a98c6e5bULL },
+            { "abc", 0x44bc2cf5ad770999ULL },
+            { "message digest", 0x066ed728fceeb3beULL },
+            { stripe_input(), 0xcbf59c5116ff32b4ULL },
+            { "Nobody inspects the spammish repetition", 0xfbcea83c8a378bf1ULL },
+            { "The quick brown fox jumps over the lazy dog", 0x0b242d361fda71bcULL },
+            { long_input(), 0xe146cb31b65bc21aULL },
+    };
+
+    for (const auto& [input, hash] : answers) {
+        const auto name = "xxh64 of " + std::to_string(input.size()) + " bytes";
+
+        check(name, x360mse::hash::xxh64(input.data(), input.size()), hash);
+
+        // Feeding the same bytes in uneven pieces must not change the hash.
+        for (const size_t piece : { 1, 7, 31, 33 }) {
+            x360mse::hash::Xxh64 hasher;
+
+            for (size_t offset = 0; offset < input.size(); offset += piece) {
+                hasher.update(input.data() + offset, std::min(piece, input.size() - offset));
+            }
+
+            check(name + " in pieces of " + std::to_string(piece), hasher.digest(), hash);
+        }
+    }
+
+    // A seed changes the initial accumulators and the short-input path.
+    {
+        x360mse::hash::Xxh64 hasher { 1 };
+        hasher.update("abc", 3);
+
+        check("xxh64 of 'abc' with seed 1", hasher.digest(), 0xbea9ca8199328908ULL);
+    }
+
+    // Files are hashed as their contents.
+    {
+        const auto path = std::filesystem::temp_directory_path() / "x360mse-hash-test.bin";
+        const auto input = long_input();
+
+        {
+            auto stream = std::ofstream { path, std::ios::binary };
+            stream.write(input.data(), static_cast<std::streamsize>(input.size()));
+        }
+
+        check("xxh64_file", x360mse::hash::xxh64_file(path), 0xe146cb31b65bc21aULL);
+
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+
+    if (x360mse::hash::to_hex(0x0b242d361fda71bcULL) != "0b242d361fda71bc") {
+        std::printf("FAILED to_hex: got %s\n", x360mse::hash::to_hex(0x0b242d361fda71bcULL).c_str());
+
+        failures += 1;
+    }
+
+    if (failures == 0) {
+        std::printf("All hash checks passed.\n");
+    }
+
+    return failures == 0 ? 0 : 1;
+}